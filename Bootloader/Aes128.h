@@ -0,0 +1,30 @@
+#ifndef AES128_H
+#define AES128_H
+
+/********************************************Library Include Start********************************************/
+#include <stdint.h>      // Fixed width types used by the cipher
+/********************************************Library Include End********************************************/
+
+/**************************************AES-128 Macros Declaration Start**************************************/
+#define AES128_BLOCK_SIZE                      16u          // Size of one AES block in bytes
+#define AES128_KEY_SIZE                        16u          // Size of an AES-128 key in bytes
+#define AES128_ROUND_KEY_WORDS                 44u          // Expanded key size in 32-bit words (11 round keys)
+/***************************************AES-128 Macros Declaration End***************************************/
+
+/*************************************AES-128 DataType Declaration Start*************************************/
+// Expanded AES-128 encryption key
+typedef struct
+{
+    uint32_t RoundKeys[AES128_ROUND_KEY_WORDS];
+} AES128_context;
+/**************************************AES-128 DataType Declaration End**************************************/
+
+/*************************************AES-128 Function Declaration Start*************************************/
+void AES128_vInit(AES128_context *Context, const uint8_t *Key);                               // Expand the key
+void AES128_vEncryptBlock(const AES128_context *Context, const uint8_t *In, uint8_t *Out);     // Encrypt one block
+// Encrypt or decrypt in CTR mode, starting Offset bytes into the keystream of the initial counter block
+void AES128_vCtrCrypt(const AES128_context *Context, const uint8_t *InitialCounter, uint32_t Offset,
+                      uint8_t *Data, uint32_t Length);
+/**************************************AES-128 Function Declaration End**************************************/
+
+#endif
@@ -1,851 +1,2514 @@
 #include"Bootloader.h"
 #include"STD_TYPES.h"
 
-static uint8 Global_u8arrBuffer[BUFFER_SIZE];
-
-/**
- * @brief   Jumps to the user application located at a specific address in flash memory.
- * 
- * This function retrieves the initial stack pointer and reset handler address of the user application
- * from a predefined memory location (flash memory). It then reconfigures the stack pointer (MSP),
- * resets the RCC configuration to the default state, and jumps to the user application's reset handler.
- */
-static void JumbToUserApplication(void)
+// Links polled for frames, the first one that starts receiving carries the frame and its reply
+static const TRANSPORT_backend* const Global_pstarrTransports[] =
 {
-    // Step 1: Retrieve the Main Stack Pointer (MSP) from the user application's vector table
-    uint32 Local_u32AppMsp = *((volatile uint32*)FLASH_SECTOR2_BASE_ADDRESS);
-    // The MSP is located at the start of the vector table (first 4 bytes)
-
-    // Step 2: Retrieve the reset handler address from the user application's vector table
-    uint32 Local_u32AppAddress = *((volatile uint32*)(FLASH_SECTOR2_BASE_ADDRESS + 4));
-    // The reset handler address is the second entry in the vector table (next 4 bytes)
-
-    // Step 3: Create a function pointer to the user application's reset handler
-    void (*ResetHandler_Address)(void) = (void (*)(void))Local_u32AppAddress;
-    // Cast the retrieved address to a function pointer type
-
-    // Step 4: Set the MSP to the value retrieved from the user application's vector table
-    __set_MSP(Local_u32AppMsp);
-    // Configure the MSP register to the application's stack pointer to ensure correct stack usage
-
-    // Step 5: De-initialize the system peripherals to reset the system state
-    HAL_RCC_DeInit();  
-    // Resets the clock configuration and all peripherals, preparing for the user application
-
-    // Step 6: Jump to the user application's reset handler
-    ResetHandler_Address();  
-    // This calls the user application's reset handler, starting its execution
-}
-
-/**
- * @brief Prints a formatted message using UART for debugging.
- *        The message format is similar to the printf style.
- * @param Format: A string that contains the format specifiers for the variable arguments.
- * @param ...: Variable arguments that match the format specifiers in the Format string.
- * 
- * @note This function uses UART to transmit the message when DEBUG_METHODE is set to UART_DEBUG.
- */
-static void PrintMessage(const char* Format, ...)
-{
-    // Buffer to store the formatted message (maximum size 100 characters).
-    char Local_u8arrMessage[100] = {0}; 
-    
-    // Variable argument list to handle the multiple arguments passed to the function.
-    va_list Local_arg;
-    
-    // Initializes the va_list variable to retrieve the additional arguments.
-    va_start(Local_arg, Format); 
-    
-    // Creates the formatted string and stores it in Local_u8arrMessage using the provided format.
-    vsprintf(Local_u8arrMessage, Format, Local_arg); 
-    
-    // Check if the debug method is set to UART, then send the message via UART.
-    #if (DEBUG_METHODE == UART_DEBUG)
-    HAL_UART_Transmit(DEBUGING_PORT, (const uint8*) Local_u8arrMessage, sizeof(Local_u8arrMessage), HAL_MAX_DELAY);
-    #endif
-    
-    // Cleans up the variable argument list.
-    va_end(Local_arg); 
-}
-
-BL_status BL_enGetCoomand()
+    &UART_TRANSPORT,
+#if (CAN_LINK_STATUS == ENABLED)
+    &CanLink_stTransport,
+#else
+    &UsbLink_stTransport,
+#endif
+#if (SPI_LINK_STATUS == ENABLED)
+    &SpiLink_stTransport,
+#endif
+};
+
+// Link the frame being handled arrived on, SendData() and SendReply() answer on it
+static const TRANSPORT_backend* Global_pstActiveTransport = &UART_TRANSPORT;
+
+// Frame error counters, indexed like Global_pstarrTransports, and those of the active transport
+static LINK_stats Global_starrLinkStats[sizeof(Global_pstarrTransports) / sizeof(Global_pstarrTransports[0])];
+static LINK_stats* Global_pstActiveLinkStats = &Global_starrLinkStats[0];
+
+#if (WATCHDOG_STATUS == ENABLED)
+// Independent watchdog, refreshed by the receive loop and inside the erase and program loops
+static IWDG_HandleTypeDef Global_stWatchdog;
+#endif
+
+#if (FEC_STATUS == ENABLED)
+// Reed-Solomon parity bytes the host appends to every frame, 0 while FEC is off
+static uint8 Global_u8FecParitySize = 0;
+#endif
+
+// Running hash of the image as it is written, Global_u32HashedEndAddress is 0 when the stream is not contiguous
+static SHA256_context Global_stImageHash;
+static uint32 Global_u32HashedEndAddress = 0;
+
+// Public key used to verify image signatures
+static const uint8 Global_u8arrSigningKey[ED25519_PUBLIC_KEY_SIZE] = IMAGE_SIGNING_PUBLIC_KEY;
+
+// Encrypted transfer state, the key is expanded once when the mode is enabled
+static const uint8 Global_u8arrDecryptionKey[AES128_KEY_SIZE] = IMAGE_DECRYPTION_KEY;
+static AES128_context Global_stAesContext;
+static uint8 Global_u8arrInitialCounter[AES128_BLOCK_SIZE];
+static uint8 Global_u8EncryptionMode = ENCRYPTION_OFF;
+
+// Update journal view of the flash page, and the end of the committed prefix of the application region
+static const volatile JOURNAL_info* const Global_pstJournal = (const volatile JOURNAL_info*)JOURNAL_PAGE_ADDRESS;
+static uint32 Global_u32CommitEndAddress = FLASH_SECTOR2_BASE_ADDRESS;
+
+// WRP groups that are write-protected (bit set), cached at startup as they only change after a reset
+static uint32 Global_u32WrpProtectedGroups = 0;
+
+// Blocks of the current broadcast session that were written (bit set), a new session clears them
+static uint8 Global_u8BroadcastSession = 0;
+static uint8 Global_u8arrBroadcastBlocks[BROADCAST_MAX_BLOCKS / 8u];
+
+#if (TRACE_STATUS == ENABLED)
+// Phase timing histograms, indexed by command code - CBL_FIRST_CMD like the command table
+static TRACE_command_stats Global_starrTrace[CBL_COMMAND_TABLE_SIZE];
+#endif
+
+#if (RAM_APPLET_STATUS == ENABLED)
+// Services handed to RAM applets started through CBL_GO_TO_ADDR_CMD
+static const BL_AppletServices Global_stAppletServices =
 {
-	BL_status Local_enBlStatus=BL_ACK;
-	HAL_StatusTypeDef Local_enUartStatus=HAL_OK;
-	uint8 Local_u8DataSize=0;
-	memset(Global_u8arrBuffer,0,BUFFER_SIZE);
-	Local_enUartStatus=HAL_UART_Receive(COMMUNICATION_PORT,Global_u8arrBuffer, 1, HAL_MAX_DELAY);
-	if(Local_enUartStatus==HAL_OK)
-	{
-		Local_u8DataSize=Global_u8arrBuffer[0];
-		Local_enUartStatus=HAL_UART_Receive(COMMUNICATION_PORT,Global_u8arrBuffer+1, Local_u8DataSize, HAL_MAX_DELAY);
-		if(Local_enUartStatus==HAL_OK)
-		{
-    switch (Global_u8arrBuffer[1]) 
-			{
-        case CBL_GET_VER_CMD:
-            #if (DEBUG_STATUS == ENABLED)
-                PrintMessage("Handling GET Version Command");
-            #endif
-            Bootloader_Get_Version(Global_u8arrBuffer);
-            break;
-        case CBL_GET_HELP_CMD:
-            #if (DEBUG_STATUS == ENABLED)
-                PrintMessage("Handling GET Help Command");
-            #endif
-            Bootloader_Get_Help(Global_u8arrBuffer);
-            break;
-        case CBL_GET_CID_CMD:
-            #if (DEBUG_STATUS == ENABLED)
-                PrintMessage("Handling GET Chip ID Command");
-            #endif
-            Bootloader_Get_Chip_Identification_Number(Global_u8arrBuffer);
-            break;
-        case CBL_GET_RDP_STATUS_CMD:
-            #if (DEBUG_STATUS == ENABLED)
-                PrintMessage("Handling GET Read Protection Status Command");
-            #endif
-            Bootloader_Read_Protection_Level(Global_u8arrBuffer);
-            break;
-        case CBL_GO_TO_ADDR_CMD:
-            #if (DEBUG_STATUS == ENABLED)
-                PrintMessage("Handling Go to Address Command");
-            #endif
-            Bootloader_Jump_To_Address(Global_u8arrBuffer);
-            break;
-        case CBL_FLASH_ERASE_CMD:
-            #if (DEBUG_STATUS == ENABLED)
-                PrintMessage("Handling Flash Erase Command");
-            #endif
-            Bootloader_Erase_Flash(Global_u8arrBuffer);
-            break;
-        case CBL_MEM_WRITE_CMD:
-            #if (DEBUG_STATUS == ENABLED)
-                PrintMessage("Handling Memory Write Command");
-            #endif
-            Bootloader_Memory_Write(Global_u8arrBuffer);
-            break;
-        case CBL_CHANGE_ROP_Level_CMD:
-            #if (DEBUG_STATUS == ENABLED)
-                PrintMessage("Handling Change ROP Level Command");
-            #endif
-            Bootloader_Change_Read_Protection_Level(Global_u8arrBuffer);
-            break;
-        default:
-            #if (DEBUG_STATUS == ENABLED)
-                PrintMessage("Unknown Command");
-            #endif
-						Local_enBlStatus=BL_NACK;
-            break;
-			}
-		}
-		else
-		{
-			Local_enBlStatus=BL_NACK;
-		}
-			
-	}
-	else
-	{
-		Local_enBlStatus=BL_NACK;
-	}
-	return Local_enBlStatus;
-}
+    Applet_SendData,
+    Applet_WriteFlash,
+    CalculateCrc,
+};
+#endif
+
+// Command table, indexed by command code - CBL_FIRST_CMD
+static const BL_command_entry Global_starrCommands[CBL_COMMAND_TABLE_SIZE] =
+{
+    [CBL_GET_VER_CMD - CBL_FIRST_CMD]          = { Bootloader_Get_Version, CBL_MIN_LENGTH(CBL_frame_header), CBL_FLAG_NONE, "GET Version" },
+    [CBL_GET_HELP_CMD - CBL_FIRST_CMD]         = { Bootloader_Get_Help, CBL_MIN_LENGTH(CBL_frame_header), CBL_FLAG_NONE, "GET Help" },
+    [CBL_GET_CID_CMD - CBL_FIRST_CMD]          = { Bootloader_Get_Chip_Identification_Number, CBL_MIN_LENGTH(CBL_frame_header), CBL_FLAG_NONE, "GET Chip ID" },
+    [CBL_GET_RDP_STATUS_CMD - CBL_FIRST_CMD]   = { Bootloader_Read_Protection_Level, CBL_MIN_LENGTH(CBL_frame_header), CBL_FLAG_NONE, "GET Read Protection Status" },
+    [CBL_GO_TO_ADDR_CMD - CBL_FIRST_CMD]       = { Bootloader_Jump_To_Address, CBL_MIN_LENGTH(CBL_go_to_addr_frame), CBL_FLAG_NONE, "Go to Address" },
+    [CBL_FLASH_ERASE_CMD - CBL_FIRST_CMD]      = { Bootloader_Erase_Flash, CBL_MIN_LENGTH(CBL_flash_erase_frame), CBL_FLAG_NEEDS_UNLOCK, "Flash Erase" },
+    [CBL_MEM_WRITE_CMD - CBL_FIRST_CMD]        = { Bootloader_Memory_Write, CBL_MEM_WRITE_MIN_LENGTH, CBL_FLAG_NEEDS_UNLOCK, "Memory Write" },
+    [CBL_RAM_WRITE_CMD - CBL_FIRST_CMD]        = { Bootloader_Ram_Write, CBL_MEM_WRITE_MIN_LENGTH, CBL_FLAG_NONE, "RAM Write" },
+    [CBL_VERIFY_IMAGE_CMD - CBL_FIRST_CMD]     = { Bootloader_Verify_Image, CBL_MIN_LENGTH(CBL_verify_image_frame), CBL_FLAG_NEEDS_UNLOCK, "Verify Image" },
+    [CBL_SET_ENCRYPTION_CMD - CBL_FIRST_CMD]   = { Bootloader_Set_Encryption, CBL_MIN_LENGTH(CBL_set_encryption_frame), CBL_FLAG_NONE, "Set Encryption" },
+    [CBL_GET_PAGE_STATE_CMD - CBL_FIRST_CMD]   = { Bootloader_Get_Page_State, CBL_MIN_LENGTH(CBL_frame_header), CBL_FLAG_NONE, "Get Page State" },
+    [CBL_BATCH_CMD - CBL_FIRST_CMD]            = { Bootloader_Batch, CBL_MIN_LENGTH(CBL_batch_frame), CBL_FLAG_NEEDS_UNLOCK, "Batch" },
+    [CBL_WRITE_OPTION_BYTES_CMD - CBL_FIRST_CMD] = { Bootloader_Write_Option_Bytes, CBL_MIN_LENGTH(CBL_option_bytes_frame), CBL_FLAG_NEEDS_UNLOCK, "Write Option Bytes" },
+    [CBL_PROTECT_BOOTLOADER_CMD - CBL_FIRST_CMD] = { Bootloader_Set_Bootloader_Protection, CBL_MIN_LENGTH(CBL_frame_header), CBL_FLAG_NEEDS_UNLOCK, "Protect Bootloader" },
+    [CBL_UNPROTECT_BOOTLOADER_CMD - CBL_FIRST_CMD] = { Bootloader_Set_Bootloader_Protection, CBL_MIN_LENGTH(CBL_frame_header), CBL_FLAG_NEEDS_UNLOCK, "Unprotect Bootloader" },
+    [CBL_UPDATE_BOOTLOADER_CMD - CBL_FIRST_CMD] = { Bootloader_Update_Bootloader, CBL_MIN_LENGTH(CBL_update_bootloader_frame), CBL_FLAG_NEEDS_UNLOCK, "Update Bootloader" },
+#if (TRACE_STATUS == ENABLED)
+    [CBL_GET_TRACE_CMD - CBL_FIRST_CMD]        = { Bootloader_Get_Trace, CBL_MIN_LENGTH(CBL_get_trace_frame), CBL_FLAG_NONE, "Get Trace" },
+#endif
+    [CBL_CHANGE_ROP_Level_CMD - CBL_FIRST_CMD] = { Bootloader_Change_Read_Protection_Level, CBL_MIN_LENGTH(CBL_change_rop_frame), CBL_FLAG_NEEDS_UNLOCK, "Change ROP Level" },
+    [CBL_BROADCAST_WRITE_CMD - CBL_FIRST_CMD]  = { Bootloader_Broadcast_Write, CBL_BROADCAST_WRITE_MIN_LENGTH, CBL_FLAG_NEEDS_UNLOCK, "Broadcast Write" },
+    [CBL_GET_GAP_REPORT_CMD - CBL_FIRST_CMD]   = { Bootloader_Get_Gap_Report, CBL_MIN_LENGTH(CBL_get_gap_report_frame), CBL_FLAG_NONE, "Get Gap Report" },
+    [CBL_GET_LINK_STATS_CMD - CBL_FIRST_CMD]   = { Bootloader_Get_Link_Stats, CBL_MIN_LENGTH(CBL_get_link_stats_frame), CBL_FLAG_NONE, "Get Link Stats" },
+#if (FEC_STATUS == ENABLED)
+    [CBL_SET_FEC_CMD - CBL_FIRST_CMD]          = { Bootloader_Set_Fec, CBL_MIN_LENGTH(CBL_set_fec_frame), CBL_FLAG_NONE, "Set FEC" },
+#endif
+};
 
 /**
- * @brief  Retrieves the bootloader version and sends it to the host if CRC verification passes.
- * 
- * This function first verifies the integrity of the received data using the CRC. If the CRC check 
- * passes, it sends an acknowledgment (ACK) to the host, followed by the bootloader version details 
- * (vendor ID, software major version, minor version, and patch version) via UART. If the CRC check 
- * fails, it does not send any data.
- * 
- * @param  Host_Buffer: A pointer to the buffer containing the received data and CRC.
- * @retval None
+ * @brief  Checks that the application at FLASH_SECTOR2_BASE_ADDRESS may be started.
+ *
+ * An erased or half-erased application region has no initial stack pointer inside SRAM. When
+ * IMAGE_SIGNATURE_CHECK is enabled, only images that passed the signature check and were not modified
+ * since are accepted. Every way into the application (idle timeout, go to address, batch jump) asks here.
+ * @retval uint8: 1 if JumbToUserApplication() may be called, otherwise 0.
  */
-static void Bootloader_Get_Version(uint8_t *Host_Buffer)
+static uint8 Application_u8IsStartable(void)
 {
-    // Step 1: Verify CRC of the received data
-    if (PASSED == CRC_enVerify(Host_Buffer)) 
-    {
-        // Step 2: If CRC passes, send an acknowledgment with a size of 4 bytes
-        SendAck(4);
-
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("Sending Version"); // Print debug message indicating version is being sent
-        #endif
-
-        // Step 3: Prepare the version information to be sent
-        uint8 Local_u8arrMessage[4] = {CBL_VENDOR_ID, CBL_SW_MAJOR_VERSION, CBL_SW_MINOR_VERSION, CBL_SW_PATCH_VERSION};
+    uint32 Local_u32AppMsp = *((volatile uint32*)FLASH_SECTOR2_BASE_ADDRESS);
 
-        // Step 4: Transmit the version information via UART
-        HAL_UART_Transmit(COMMUNICATION_PORT, (const uint8*)Local_u8arrMessage, 4, HAL_MAX_DELAY);
+    if ((Local_u32AppMsp <= SRAM_START_ADDRESS) || (Local_u32AppMsp > (SRAM_END_ADDRESS + 1u)))
+    {
+        return 0;
     }
-    else
+
+    #if (IMAGE_SIGNATURE_CHECK == ENABLED)
+    if (!Image_u8IsBootable())
     {
-        // Step 5: If CRC fails, you may want to send a NACK or handle it accordingly
         #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("CRC Failed, not sending version"); // Optional debug message for failed CRC
+        Log_vWrite(LOG_IMAGE_NOT_VERIFIED, 0);
         #endif
-        SendNAck();
+        return 0;
     }
-}
+    #endif
 
+    return 1;
+}
 
 /**
- * @brief   Handles the "Get Help" command from the bootloader host.
- * 
- * This function is responsible for processing the "Get Help" command sent from the host.
- * It verifies the integrity of the received data using CRC, sends an acknowledgment, 
- * and transmits a list of supported commands to the host over UART.
- * 
- * @param   Host_Buffer Pointer to the buffer containing the received data from the host.
+ * @brief   Jumps to the user application located at a specific address in flash memory.
  * 
- * @note    The function assumes UART communication is available and uses blocking mode for data transmission.
+ * This function flushes and stops every link, resets the RCC configuration to the default state, then
+ * loads the initial stack pointer from the application's vector table and calls its reset handler.
+ * All de-initialization runs on the bootloader stack, before the MSP is switched.
+ * The caller checks Application_u8IsStartable() first, the function does not return.
  */
-static void Bootloader_Get_Help(uint8_t *Host_Buffer)
+static void JumbToUserApplication(void)
 {
-    // Step 1: Verify CRC of the received data
-    if (PASSED == CRC_enVerify(Host_Buffer))  // Check if CRC verification is successful
-    {
-        // Step 2: If CRC passes, send an acknowledgment with a size of 12 bytes
-        SendAck(12);  // Send an acknowledgment to the host indicating readiness to send 12 bytes
+    // Step 1: Let the last reply and the debug records leave, then stop every link so no DMA transfer or
+    //         interrupt of the bootloader is left running into the application's RAM and vector table
+    Global_pstActiveTransport->Flush();
+    #if (DEBUG_STATUS == ENABLED)
+    Log_vFlush();
+    #endif
+    #if (CAN_LINK_STATUS == ENABLED)
+    CanLink_vDeInit();  // The application must not take the bootloader's CAN interrupt
+    #else
+    UsbLink_vDeInit();  // The application must not take the bootloader's USB interrupt
+    #endif
+    #if (SPI_LINK_STATUS == ENABLED)
+    SpiLink_vDeInit();  // Nor the NSS line or the SPI DMA channels
+    #endif
+    UartLink_vDeInit();  // Stop the circular RX DMA, it would keep writing into the application's RAM
 
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("Sending Commands");  // Print debug message indicating that commands are being sent
-        #endif
+    // Step 2: Reset the clock configuration, the application starts from the reset clock tree
+    HAL_RCC_DeInit();
 
-        // Step 3: Prepare the list of commands to be sent to the host
-        uint8 Local_u8arrMessage[8] = {
-            CBL_GET_VER_CMD,             // Command 1: Get version
-            CBL_GET_HELP_CMD,            // Command 2: Get help
-            CBL_GET_CID_CMD,             // Command 3: Get Chip ID
-            CBL_GET_RDP_STATUS_CMD,      // Command 4: Get Read Protection Status
-            CBL_GO_TO_ADDR_CMD,          // Command 5: Go to specific address
-            CBL_FLASH_ERASE_CMD,         // Command 6: Flash erase
-            CBL_MEM_WRITE_CMD,           // Command 7: Memory write
-            CBL_CHANGE_ROP_Level_CMD     // Command 8: Change Read Out Protection Level
-        };
-
-        // Step 4: Transmit the array of commands via UART to the host
-        HAL_UART_Transmit(COMMUNICATION_PORT, (const uint8*)Local_u8arrMessage, 12, HAL_MAX_DELAY); 
-        // Send the 12 command bytes using UART, blocking until transmission is complete
-    }
-    else  // If CRC check fails
-    {
-        // Step 5: If CRC fails, handle the error by sending a NACK or any custom error handling
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("CRC Failed, not sending Commands");  // Optional debug message for failed CRC
-        #endif
+    // Step 3: Point VTOR at the application's vector table, the base moves with BOOTLOADER_REGION_SIZE
+    SCB->VTOR = FLASH_SECTOR2_BASE_ADDRESS;
 
-        SendNAck();  // Send a negative acknowledgment (NACK) to the host indicating failure
-    }
+    // Step 4: Load the application's MSP (first vector table entry). Nothing may use the bootloader stack
+    //         after this, so the reset handler (second entry) is read straight from flash and called
+    __set_MSP(*((volatile uint32*)FLASH_SECTOR2_BASE_ADDRESS));
+    ((void (*)(void))(*((volatile uint32*)(FLASH_SECTOR2_BASE_ADDRESS + 4u))))();
 }
 
 /**
- * @brief   Handles the "Get Chip Identification Number" command from the bootloader host.
- * 
- * This function processes the command to retrieve the Chip Identification Number (IDCODE) 
- * from the microcontroller. It verifies the CRC of the received data, sends an acknowledgment, 
- * and transmits the chip ID via UART.
- * 
- * @param   Host_Buffer Pointer to the buffer containing the received data from the host.
+ * @brief  Restores the bootloader state kept in flash after a reset.
+ *
+ * The write protection bitmap is cached so protected pages are refused before any erase or write.
+ * The update journal is scanned for the pages committed by an interrupted update, so memory writes
+ * that continue from the first uncommitted page keep extending the journal.
  */
-static void Bootloader_Get_Chip_Identification_Number(uint8_t *Host_Buffer)
+void BL_vInit(void)
 {
-    // Step 1: Verify the CRC of the received data from the host
-    if (PASSED == CRC_enVerify(Host_Buffer))  // Check if the CRC verification is successful
-    {
-        // Step 2: If CRC passes, send an acknowledgment with a size of 2 bytes (IDCODE size)
-        SendAck(2);  // Send acknowledgment to indicate readiness to send 2 bytes of Chip ID
-
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("Sending Chip Identification Number");  // Optional debug message for sending Chip ID
-        #endif
+    uint16 Local_u16Page = 0;
+    FLASH_OBProgramInitTypeDef Local_stOptionBytes;
 
-        // Step 3: Retrieve the Chip Identification Number (IDCODE)
-        uint16 Local_u16ChipIdentificationCode = (uint16)((DBGMCU->IDCODE) & IDCODE_MASK);
-        // The Chip ID is retrieved by masking the DBGMCU->IDCODE register
+    #if (TRACE_STATUS == ENABLED)
+    Trace_vInit();
+    #endif
 
-        // Step 4: Transmit the Chip Identification Number via UART
-        HAL_UART_Transmit(COMMUNICATION_PORT, (const uint8*)&Local_u16ChipIdentificationCode, 2, HAL_MAX_DELAY); 
-        // Send the 2-byte Chip ID over UART
-    }
-    else  // If the CRC check fails
+    #if (WATCHDOG_STATUS == ENABLED)
+    // Start the IWDG first, everything below already runs under it; it stops while a debugger halts the core
+    __HAL_DBGMCU_FREEZE_IWDG();
+    Global_stWatchdog.Instance = IWDG;
+    Global_stWatchdog.Init.Prescaler = WATCHDOG_PRESCALER;
+    Global_stWatchdog.Init.Reload = WATCHDOG_RELOAD;
+    if (HAL_IWDG_Init(&Global_stWatchdog) != HAL_OK)
     {
-        // Step 5: Handle CRC failure by sending a NACK to the host
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("CRC Failed, not sending Chip Identification Number");  // Optional debug message for failed CRC
-        #endif
-
-        SendNAck();  // Send a negative acknowledgment (NACK) to the host
+        Error_Handler();
     }
-}
-
+    #endif
 
+    // Cache the write protection, a WRPR bit at 0 protects its page group
+    HAL_FLASHEx_OBGetConfig(&Local_stOptionBytes);
+    Global_u32WrpProtectedGroups = ~Local_stOptionBytes.WRPPage;
 
-/**
- * @brief  This function reads the current read protection (RDP) level of the flash memory.
- *         It verifies the CRC of the received data before retrieving the protection level.
- *         If the CRC verification is successful, it sends an acknowledgment (ACK) and the RDP level.
- *         If the CRC fails, it sends a negative acknowledgment (NACK).
- * @param  Host_Buffer: Pointer to the buffer received from the host.
- * @retval None
- */
-static void Bootloader_Read_Protection_Level(uint8_t *Host_Buffer)
-{
-    // Step 1: Verify the CRC of the received data from the host
-    if (PASSED == CRC_enVerify(Host_Buffer))  // Check if the CRC verification is successful
+    // Count the committed prefix of the application region
+    if (Global_pstJournal->Magic == JOURNAL_MAGIC)
     {
-        // Step 2: If CRC passes, send an acknowledgment with a size of 1 byte (since RDPLevel is 1 byte)
-        SendAck(1);  // Send acknowledgment to indicate readiness to send RDP level
+        while ((Local_u16Page < APPLICATION_PAGE_COUNT) &&
+               (Global_pstJournal->Pages[Local_u16Page].Committed == JOURNAL_MARK_SET))
+        {
+            Local_u16Page++;
+        }
+    }
+    Global_u32CommitEndAddress = FLASH_SECTOR2_BASE_ADDRESS + ((uint32)Local_u16Page * PAGE_SIZE);
 
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("Getting Protection Level");  // Debug message indicating protection level retrieval
-        #endif
+    #if (DEBUG_STATUS == ENABLED)
+    Log_vWrite(LOG_JOURNAL_RESUME_PAGE, Local_u16Page);
+    #endif
 
-        // Step 3: Retrieve the current Read Protection Level (RDP)
-        uint8 Local_u8Message;
-        
-        // Initialize the configuration structure to read the Option Bytes
-        FLASH_OBProgramInitTypeDef Local_stConfig;
-        
-        // Retrieve the Option Bytes configuration, which contains the RDP level
-        HAL_FLASHEx_OBGetConfig(&Local_stConfig);
-        
-        // Store the RDP level into Local_u8Message
-        Local_u8Message = Local_stConfig.RDPLevel;
+    // Start the circular DMA reception, frames are then taken straight out of the ring
+    #if (RS485_LINK_STATUS == ENABLED)
+    UartLink_vInitRs485();  // Mute until a frame is addressed to this node
+    #if (DEBUG_STATUS == ENABLED)
+    Log_vWrite(LOG_RS485_NODE_ID, UartLink_u8GetNodeId());
+    #endif
+    #else
+    UartLink_vInit();
+    #endif
 
-        // Step 4: Transmit the Read Protection Level (1 byte) via UART
-        HAL_UART_Transmit(COMMUNICATION_PORT, (const uint8*)&Local_u8Message, 1, HAL_MAX_DELAY); 
-        // Send the 1-byte RDP level over UART
-    }
-    else  // If the CRC check fails
-    {
-        // Step 5: Handle CRC failure by sending a NACK to the host
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("CRC Failed, not Getting Protection Level");  // Debug message for failed CRC
-        #endif
+    #if (CAN_LINK_STATUS == ENABLED)
+    // Join the CAN bus instead of connecting USB, the two peripherals share their packet SRAM
+    UsbLink_vDeInit();
+    CanLink_vInit();
+    #else
+    // Connect the USB device, the host can send frames once it has configured it
+    UsbLink_vInit();
+    #endif
 
-        SendNAck();  // Send a negative acknowledgment (NACK) to the host
-    }
+    #if (SPI_LINK_STATUS == ENABLED)
+    // Arm the first SPI window, READY tells the companion processor it may clock
+    SpiLink_vInit();
+    #endif
+
+    #if (IDLE_CLOCK_STATUS == ENABLED)
+    // Wait for the host at 8 MHz, a stray boot into the bootloader should not burn full power
+    SetCoreClock(RCC_SYSCLKSOURCE_HSI);
+    #endif
 }
 
 /**
- * @brief  This function handles the process of verifying the host-provided data, validating the address,
- *         and performing a jump to the specified address (if valid) in the STM32 bootloader.
- * 
- * @param  Host_Buffer: A pointer to the buffer that contains the data received from the host. The address to jump to 
- *                      is stored in this buffer at an offset of 2 bytes.
+ * @brief  Waits for a complete frame and returns a pointer to it inside the receive buffer of its link.
+ *
+ * Every transport is polled, the first one that starts receiving carries the frame and its reply.
+ * Between polls the core sleeps with WFI, the link interrupts and the 1 ms SysTick wake it up. The
+ * frame stays valid until the host sends the next one, as the host waits for the reply before
+ * sending again. A frame that is not complete within FRAME_TIMEOUT is dropped and the wait starts
+ * over, so a host that stops halfway through a frame neither hangs the bootloader nor stops the
+ * idle timeout.
+ * @retval Pointer to the length byte of the frame, NULL if no frame arrived within IDLE_TIMEOUT.
  */
-
-static void Bootloader_Jump_To_Address(uint8_t *Host_Buffer)
+static uint8* ReceiveFrame(void)
 {
-    // Step 1: Verify the CRC of the received data from the host
-    if (PASSED == CRC_enVerify(Host_Buffer))  // Check if the CRC verification is successful
-    {
-        uint8 Local_u8Message = ADDRESS_IS_INVALID;  // Initialize message to indicate invalid address
-        
-        // Step 2: If CRC passes, send an acknowledgment to indicate readiness to send 2 bytes of Chip ID
-        SendAck(1);  // Send acknowledgment to the host
-
-        // Step 3: Retrieve the address to jump to, which is 32 bits (4 bytes) starting from the 3rd byte of Host_Buffer
-        uint32 Local_u32Address = *((uint32*)(Host_Buffer + 2));
+    const TRANSPORT_backend* Local_pstTransport = NULL;
+    uint8* Local_pu8Frame = NULL;
+    uint8 Local_u8Index = 0;
+    uint32 Local_u32IdleStart = HAL_GetTick();
+    uint32 Local_u32FrameStart = 0;
 
-        // Step 4: Validate the address - ensure it falls within valid Flash or SRAM address ranges
-        if (((Local_u32Address >= FLASH_START_ADDRESS) && (Local_u32Address <= FLASH_END_ADDRESS)) ||
-            ((Local_u32Address >= SRAM_START_ADDRESS) && (Local_u32Address <= SRAM_END_ADDRESS)))
+    while (NULL == Local_pu8Frame)
+    {
+        // Step 1: Wait for the first bytes of a frame on any link, sleeping until the next interrupt in between
+        Local_pstTransport = NULL;
+        while (NULL == Local_pstTransport)
         {
-            // Step 5: Create a function pointer and set it to the address retrieved, adding +1 for Thumb mode
-            void (*Local_fpAddress)(void) = (void (*)(void))(Local_u32Address + 1);
-
-            Local_u8Message = ADDRESS_IS_VALID;  // Update message to indicate valid address
+            BL_WATCHDOG_REFRESH();  // Step 3 is bounded by FRAME_TIMEOUT, well below the watchdog period
+            #if (IDLE_TIMEOUT != 0u)
+            if ((HAL_GetTick() - Local_u32IdleStart) >= IDLE_TIMEOUT)
+            {
+                return NULL;
+            }
+            #endif
+            for (Local_u8Index = 0; Local_u8Index < (sizeof(Global_pstarrTransports) / sizeof(Global_pstarrTransports[0])); Local_u8Index++)
+            {
+                if (Global_pstarrTransports[Local_u8Index]->Receiving())
+                {
+                    Local_pstTransport = Global_pstarrTransports[Local_u8Index];
+                    break;
+                }
+            }
 
-            // Send the valid address acknowledgment to the host
-            HAL_UART_Transmit(COMMUNICATION_PORT, (const uint8*)&Local_u8Message, 1, HAL_MAX_DELAY);
+            if (NULL == Local_pstTransport)
+            {
+                __WFI();
+            }
+        }
+        BL_TRACE_START(TRACE_PHASE_RECEIVE);
 
+        // Step 2: Replies go back on the link the frame arrived on, its CRC result counts for that link
+        if (Local_pstTransport != Global_pstActiveTransport)
+        {
+            Global_pstActiveTransport = Local_pstTransport;
+            Global_pstActiveLinkStats = &Global_starrLinkStats[Local_u8Index];
             #if (DEBUG_STATUS == ENABLED)
-            PrintMessage("Jumping TO The Address");  // Optional debug message for jumping
+            Log_vWrite(LOG_LINK_CHANGED, Local_pstTransport->LinkSpeed());
             #endif
+        }
 
-            // Step 6: Jump to the retrieved address (execute function at that address)
-            Local_fpAddress();
+        // Step 3: Wait for the rest of the frame, drop it if the host stops sending and go back to step 1
+        Local_u32FrameStart = HAL_GetTick();
+        while ((NULL == (Local_pu8Frame = Local_pstTransport->ReceiveFrame())) &&
+               ((HAL_GetTick() - Local_u32FrameStart) < FRAME_TIMEOUT))
+        {
         }
-        else
+        if (NULL == Local_pu8Frame)
         {
-            // Address is outside valid ranges (Flash/SRAM)
+            Local_pstTransport->Discard();
             #if (DEBUG_STATUS == ENABLED)
-            PrintMessage("Invalid Address");  // Optional debug message for invalid address
+            Log_vWrite(LOG_FRAME_TIMEOUT, FRAME_TIMEOUT);
             #endif
-            
-            // Send an invalid address acknowledgment to the host
-            HAL_UART_Transmit(COMMUNICATION_PORT, (const uint8*)&Local_u8Message, 1, HAL_MAX_DELAY);
         }
     }
-    else  // If the CRC check fails
-    {
-        // Step 7: Handle CRC failure by sending a NACK to the host
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("Not Jumping To The Address");  // Optional debug message for failed CRC
-        #endif
+    BL_TRACE_STOP(TRACE_PHASE_RECEIVE);
 
-        SendNAck();  // Send a negative acknowledgment (NACK) to the host
-    }
+    return Local_pu8Frame;
 }
 
 /**
- * @brief Erases flash memory pages based on the received command from the host.
- *
- * This function first verifies the integrity of the received data using CRC. 
- * If the CRC verification is successful, it proceeds to erase the specified flash pages 
- * and sends an acknowledgment back to the host. If the CRC verification fails, it sends a NACK.
+ * @brief  Starts the application once BL_enGetCommand() returned BL_IDLE_TIMEOUT.
  *
- * @param Host_Buffer Pointer to the buffer containing the command and parameters from the host.
- *                    The buffer is expected to contain:
- *                    - Host_Buffer[2]: Starting page address for the erase operation.
- *                    - Host_Buffer[3]: Number of pages to erase.
- */
-static void Bootloader_Erase_Flash(uint8_t *Host_Buffer) {
-    // Step 1: Verify CRC of the received data
-    if (PASSED == CRC_enVerify(Host_Buffer)) {
-        // Step 2: If CRC passes, send an acknowledgment with a size of 4 bytes
-        SendAck(1);
-
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("Erasing Flash"); // Print debug message indicating that the flash is being erased
-        #endif
-
-        // Step 3: Call EraseFlashPages to perform the flash erase operation
-        uint8_t Local_u8Message = EraseFlashPages(Host_Buffer[2], Host_Buffer[3]);
-
-        // Step 4: Transmit the result of the erase operation via UART
-        HAL_UART_Transmit(COMMUNICATION_PORT, (const uint8_t*)&Local_u8Message, 1, HAL_MAX_DELAY);
-    } 
-    else {
-        // Step 5: If CRC fails, send a NACK or handle it accordingly
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("CRC Failed, not Erasing Flash"); // Optional debug message for failed CRC
-        #endif
-        SendNAck(); // Send negative acknowledgment to the host
-    }
-}
-
-
-/**
- * @brief  This function writes data from the host to the flash memory of the device.
- *         It verifies the CRC of the received data before proceeding with the flash write.
- *         If the CRC passes, the flash memory is written; otherwise, it sends a negative acknowledgment.
- * @param  Host_Buffer: Pointer to the buffer containing the data to be written to flash.
- *                      The buffer includes the address and the data to be written.
- * @retval None
+ * Called from the main loop, outside the receive path, so no frame or reply is in progress.
+ * An application that fails Application_u8IsStartable() is not started, the bootloader then stays
+ * in the command loop. JumbToUserApplication() de-initializes the links before the jump.
+ * @retval None, returns only if the application cannot be started.
  */
-static void Bootloader_Memory_Write(uint8_t *Host_Buffer)
+void BL_vStartApplication(void)
 {
-    // Step 1: Verify CRC of the received data to ensure its integrity
-    if (PASSED == CRC_enVerify(Host_Buffer)) {
-        // Step 2: If CRC verification passes, send an acknowledgment (ACK) with a size of 1 byte
-        SendAck(1);
-
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("Writing Flash"); // Print debug message indicating the flash write process is starting
-        #endif
-        
-        // Step 3: Extract the target flash address from the received buffer
-        //         The address is located starting from byte 2 in the buffer.
-        uint32 Local_u32Address = *((uint32*)(Host_Buffer + 2));
-
-        // Step 4: Call WriteFlash to write the data to flash memory
-        //         Host_Buffer+7: Points to the data to be written
-        //         Host_Buffer[6]: Specifies the length of the data
-        //         Local_u32Address: The flash memory address where the data will be written
-        uint8_t Local_u8Message = WriteFlash(Host_Buffer + 7, Host_Buffer[6], Local_u32Address);
-
-        // Step 5: Transmit the result of the flash write operation via UART
-        //         This sends back a status byte indicating whether the write operation was successful
-        HAL_UART_Transmit(COMMUNICATION_PORT, (const uint8_t*)&Local_u8Message, 1, HAL_MAX_DELAY);
-    } 
-    else {
-        // Step 6: If CRC verification fails, send a negative acknowledgment (NACK) to the host
+    if (Application_u8IsStartable())
+    {
         #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("CRC Failed, not Writing Flash"); // Debug message indicating CRC failure
+        Log_vWrite(LOG_IDLE_TIMEOUT, IDLE_TIMEOUT);
         #endif
-
-        // Send a NACK to notify the host that the data was corrupted and not written
-        SendNAck();
+        JumbToUserApplication();
     }
 }
 
-
+#if (IDLE_CLOCK_STATUS == ENABLED)
 /**
- * @brief  Bootloader function to change the Read-Out Protection (ROP) level based on the host request.
- *         This function verifies the received data's CRC, acknowledges the host, retrieves the chip ID,
- *         and transmits the new ROP level or a failure message via UART.
- * @param  Host_Buffer: Pointer to the buffer that holds the received data from the host, including the new ROP level.
+ * @brief  Runs the core and the buses from HSI (8 MHz, APB1 undivided) or from the PLL (72 MHz, APB1 36 MHz).
+ *
+ * The PLL keeps running while the core is on HSI, so the USB clock stays at 48 MHz. USART2 and USART3
+ * sit on APB1, their baud rate registers are recomputed for the new clock once the pending replies and
+ * debug records left at the old rate. SysTick keeps its 1 ms period through HAL_RCC_ClockConfig().
+ * @param  Copy_u32Source: RCC_SYSCLKSOURCE_HSI or RCC_SYSCLKSOURCE_PLLCLK.
  * @retval None
  */
-static void Bootloader_Change_Read_Protection_Level(uint8_t *Host_Buffer)
+static void SetCoreClock(uint32 Copy_u32Source)
 {
-    // Step 1: Verify the CRC of the received data from the host
-    if (PASSED == CRC_enVerify(Host_Buffer))  // Check if the CRC verification is successful
-    {
-        // Step 2: If CRC passes, send an acknowledgment with a size of 1 byte
-        SendAck(1);  // Send acknowledgment to indicate readiness to receive the ROP level
-
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("Changing ROP Level");  // Debug message to indicate the start of ROP level change
-        #endif
+    RCC_ClkInitTypeDef Local_stClocks = {0};
+    uint32 Local_u32Latency = FLASH_LATENCY_0;
 
-        // Step 3: Change the ROP level based on the data from the host
-        uint8 Local_u8Message = ChangeROPLevel(Host_Buffer[2]);  // Pass the ROP level from the host buffer
+    // Step 1: Let the transmissions in progress finish at the old baud rate
+    Global_pstActiveTransport->Flush();
+    #if (DEBUG_STATUS == ENABLED)
+    Log_vFlush();
+    #endif
 
-        // Step 4: Transmit the status of ROP change operation via UART
-        HAL_UART_Transmit(COMMUNICATION_PORT, (const uint8*)&Local_u8Message, 1, HAL_MAX_DELAY); 
-        // Send the 1-byte status (ROP change success or failure) over UART
+    // Step 2: Switch SYSCLK, the flash wait states follow the new frequency
+    Local_stClocks.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+    Local_stClocks.SYSCLKSource = Copy_u32Source;
+    Local_stClocks.AHBCLKDivider = RCC_SYSCLK_DIV1;
+    Local_stClocks.APB1CLKDivider = RCC_HCLK_DIV1;
+    Local_stClocks.APB2CLKDivider = RCC_HCLK_DIV1;
+    if (Copy_u32Source == RCC_SYSCLKSOURCE_PLLCLK)
+    {
+        Local_stClocks.APB1CLKDivider = RCC_HCLK_DIV2;  // APB1 is limited to 36 MHz
+        Local_u32Latency = FLASH_LATENCY_2;
     }
-    else  // If the CRC check fails
+    if (HAL_RCC_ClockConfig(&Local_stClocks, Local_u32Latency) != HAL_OK)
     {
-        // Step 5: Handle CRC failure by sending a negative acknowledgment (NACK) to the host
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("CRC Failed, not Changing ROP Level");  // Debug message to indicate CRC failure
-        #endif
-
-        SendNAck();  // Send a negative acknowledgment (NACK) to the host indicating CRC failure
+        return;
     }
-}
 
+    // Step 3: Keep the baud rates of the command and debug UARTs
+    huart2.Instance->BRR = UART_BRR_SAMPLING16(HAL_RCC_GetPCLK1Freq(), huart2.Init.BaudRate);
+    huart3.Instance->BRR = UART_BRR_SAMPLING16(HAL_RCC_GetPCLK1Freq(), huart3.Init.BaudRate);
+
+    #if (DEBUG_STATUS == ENABLED)
+    Log_vWrite(LOG_CORE_CLOCK, SystemCoreClock);
+    #endif
+}
+#endif
 
 /**
- * @brief  Verifies the CRC (Cyclic Redundancy Check) of data received from the host.
- * 
- * This function calculates the CRC for the data received in the `Host_Buffer` and compares it 
- * to the CRC sent by the host (appended at the end of the data). The size of the data, including
- * the CRC, is determined by the first byte of the `Host_Buffer`.
- * 
- * @param  Host_Buffer: A pointer to the buffer containing the received data and the appended CRC.
- * @retval CRC_status: Returns PASSED if the calculated CRC matches the host's CRC, otherwise FAILED.
+ * @brief  Receives one frame and dispatches it through the command table.
+ *
+ * With FEC on, the frame is first corrected with its Reed-Solomon parity, which is then stripped.
+ * The command byte indexes Global_starrCommands directly. The frame length and the CRC are checked
+ * here for every command, so the handlers only carry out the command and hand their reply to
+ * SendReply(), which sends the ACK and the reply as one transmission. Commands flagged
+ * CBL_FLAG_NEEDS_UNLOCK run with the flash unlocked.
+ * @retval BL_status: BL_ACK if the command was executed, BL_IDLE_TIMEOUT if the host stayed silent
+ *         for IDLE_TIMEOUT, otherwise BL_NACK.
  */
-static CRC_status CRC_enVerify(uint8 *Host_Buffer)
+BL_status BL_enGetCommand()
 {
-    // Initialize status as PASSED
-    CRC_status Local_enStatus = PASSED;
-
-    // Calculate the total length of data, including CRC
-    uint8 Local_u8DataLength = Host_Buffer[0] + 1; 
+    BL_status Local_enBlStatus = BL_NACK;
+    uint8* Local_pu8Frame = ReceiveFrame();
+    const CBL_frame_header* Local_pstHeader = (const CBL_frame_header*)Local_pu8Frame;
+    const BL_command_entry* Local_pstEntry = NULL;
 
-    // Extract the CRC value sent by the host from the buffer (last 4 bytes)
-    uint32 Local_u32HostCrc = *((uint32*)(Host_Buffer + Local_u8DataLength - CRC_SIZE)); 
-
-    // Variable to store calculated CRC
-    uint32 Local_u32McuCrc = 0;
-
-    // Temporary variable to hold data for CRC calculation
-    uint32 Local_u32Data = 0;
-
-    // Counter to loop through the data bytes (excluding CRC)
-    uint8 Local_u8Counter = 0;
+    if (NULL == Local_pu8Frame)
+    {
+        return BL_IDLE_TIMEOUT;  // Nothing received, the caller decides whether to start the application
+    }
 
-    // Loop through the buffer and accumulate CRC for each byte
-    for (Local_u8Counter = 0; Local_u8Counter < Local_u8DataLength - CRC_SIZE; Local_u8Counter++) 
+    #if (FEC_STATUS == ENABLED)
+    // Step 1: Repair byte errors (the command byte included) before anything is read, then strip the parity
+    if (0u != Global_u8FecParitySize)
     {
-        Local_u32Data = (uint32)Host_Buffer[Local_u8Counter]; // Cast the byte to 32-bit
-        Local_u32McuCrc = HAL_CRC_Accumulate(CRC_ENGINE, (uint32_t*)&Local_u32Data, 1); // Accumulate CRC
+        CorrectFrame(Local_pu8Frame);
     }
+    #endif
 
-    // Reset the CRC engine data register after calculation
-    __HAL_CRC_DR_RESET(CRC_ENGINE);
+    // Step 2: Look the command up in the table
+    if ((Local_pstHeader->Command >= CBL_FIRST_CMD) && (Local_pstHeader->Command <= CBL_LAST_CMD))
+    {
+        Local_pstEntry = &Global_starrCommands[Local_pstHeader->Command - CBL_FIRST_CMD];
+    }
 
-    // Compare the CRC received from the host with the one calculated by MCU
-    if (Local_u32HostCrc != Local_u32McuCrc)
+    if ((NULL == Local_pstEntry) || (NULL == Local_pstEntry->Handler))
     {
         #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("CRC_FAILED"); // Print debug message if CRC check fails
+        Log_vWrite(LOG_UNKNOWN_COMMAND, Local_pstHeader->Command);
         #endif
-        Local_enStatus = FAILED; // Mark status as failed
+        SendNAck();
+    }
+    // Step 3: Reject frames too short for the command fields, then verify the CRC
+    else if ((Local_pstHeader->Length < Local_pstEntry->MinLength) || (PASSED != CRC_enVerify(Local_pu8Frame)))
+    {
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_INVALID_FRAME, Local_pstHeader->Command);
+        #endif
+        SendNAck();
     }
     else
     {
         #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("CRC_PASSED"); // Print debug message if CRC check passes
+        Log_vWrite(LOG_HANDLING_COMMAND, Local_pstHeader->Command);
+        #endif
+
+        #if (IDLE_CLOCK_STATUS == ENABLED)
+        // A host is there, run the session at full speed
+        if (__HAL_RCC_GET_SYSCLK_SOURCE() != RCC_SYSCLKSOURCE_STATUS_PLLCLK)
+        {
+            SetCoreClock(RCC_SYSCLKSOURCE_PLLCLK);
+        }
         #endif
+
+        // Step 4: Run the handler, with the flash unlocked if it programs flash or option bytes
+        if (0u != (Local_pstEntry->Flags & CBL_FLAG_NEEDS_UNLOCK))
+        {
+            HAL_FLASH_Unlock();
+            Local_pstEntry->Handler(Local_pu8Frame);
+            HAL_FLASH_Lock();
+        }
+        else
+        {
+            Local_pstEntry->Handler(Local_pu8Frame);
+        }
+
+        Local_enBlStatus = BL_ACK;
     }
 
-    return Local_enStatus; // Return the CRC status
+    #if (TRACE_STATUS == ENABLED)
+    // Step 5: Account the frame to its command, rejected frames only reset the phase totals
+    Trace_vEndFrame((BL_ACK == Local_enBlStatus) ? &Global_starrTrace[Local_pstHeader->Command - CBL_FIRST_CMD] : NULL);
+    #endif
+
+    return Local_enBlStatus;
 }
 
 /**
- * @brief  Sends an acknowledgment (ACK) message to the host.
- * 
- * This function sends a message that consists of the acknowledgment byte (ACK) followed by 
- * a size byte that specifies the expected size of the data. The message is transmitted 
- * via the UART communication port using HAL_UART_Transmit.
- * 
- * @param  Copy_u8Size: The size of the acknowledgment message to be sent.
+ * @brief  Sends the bootloader version (vendor ID, major, minor and patch version) to the host.
+ * @param  Host_Buffer: A pointer to the received frame.
  * @retval None
  */
-static void SendAck(uint8 Copy_u8Size)
+static void Bootloader_Get_Version(uint8_t *Host_Buffer)
 {
-    // Send an acknowledgment message with the size of the ACK
-    uint8 Local_u8arrMessage[2] = {ACK, Copy_u8Size};
+    // Step 1: Prepare the version information to be sent
+    uint8 Local_u8arrMessage[4] = {CBL_VENDOR_ID, CBL_SW_MAJOR_VERSION, CBL_SW_MINOR_VERSION, CBL_SW_PATCH_VERSION};
 
-    // Transmit the ACK message via UART, blocking until the transmission is complete
-    HAL_UART_Transmit(COMMUNICATION_PORT, (const uint8*)Local_u8arrMessage, 2, HAL_MAX_DELAY);
+    // Step 2: Send the ACK and the version information
+    SendReply((const uint8*)Local_u8arrMessage, sizeof(Local_u8arrMessage));
 }
 
+
 /**
- * @brief  Sends a negative acknowledgment (NACK) message to the host.
+ * @brief   Handles the "Get Help" command from the bootloader host.
  * 
- * This function sends a negative acknowledgment (NACK) to indicate that the received data 
- * was not processed correctly. The message is transmitted via the UART communication port 
- * using HAL_UART_Transmit.
+ * The list of supported commands is generated from the command table, so a command added to the
+ * table is reported without touching this handler.
  * 
- * @retval None
+ * @param   Host_Buffer Pointer to the received frame.
  */
-static void SendNAck()
+static void Bootloader_Get_Help(uint8_t *Host_Buffer)
 {
-    // Send a negative acknowledgment (NACK) message via UART, blocking until complete
-    HAL_UART_Transmit(COMMUNICATION_PORT, (const uint8*)NACK, 1, HAL_MAX_DELAY);
+    uint8 Local_u8arrMessage[CBL_COMMAND_TABLE_SIZE];
+    uint8 Local_u8Count = 0;
+    uint8 Local_u8Index = 0;
+
+    // Step 1: Collect the codes of all commands present in the table
+    for (Local_u8Index = 0; Local_u8Index < CBL_COMMAND_TABLE_SIZE; Local_u8Index++)
+    {
+        if (NULL != Global_starrCommands[Local_u8Index].Handler)
+        {
+            Local_u8arrMessage[Local_u8Count] = (uint8)(CBL_FIRST_CMD + Local_u8Index);
+            Local_u8Count++;
+        }
+    }
+
+    // Step 2: Send the ACK announcing the size of the command list together with the list
+    SendReply((const uint8*)Local_u8arrMessage, Local_u8Count);
 }
 
 /**
- * @brief Erases specified flash memory pages.
- *
- * This function can perform either a mass erase of the entire flash memory or erase a specified number of pages.
- *
- * @param Copy_u32PageAddress The starting address of the page to erase or a predefined constant for mass erase.
- * @param Copy_u32NumberOfPages The number of pages to erase (only applicable if not performing a mass erase).
- *
- * @return FLASH_status Status of the erase operation:
- *         - SUCCESSFUL_ERASE: Erase operation was successful.
+ * @brief   Sends the Chip Identification Number (IDCODE) to the host.
+ * @param   Host_Buffer Pointer to the received frame.
+ */
+static void Bootloader_Get_Chip_Identification_Number(uint8_t *Host_Buffer)
+{
+    // Step 1: Retrieve the Chip Identification Number (IDCODE)
+    uint16 Local_u16ChipIdentificationCode = (uint16)((DBGMCU->IDCODE) & IDCODE_MASK);
+    // The Chip ID is retrieved by masking the DBGMCU->IDCODE register
+
+    // Step 2: Send the ACK and the Chip Identification Number
+    SendReply((const uint8*)&Local_u16ChipIdentificationCode, 2);
+}
+
+/**
+ * @brief  Sends the current read protection (RDP) level of the flash memory to the host.
+ * @param  Host_Buffer: Pointer to the received frame.
+ * @retval None
+ */
+static void Bootloader_Read_Protection_Level(uint8_t *Host_Buffer)
+{
+    // Step 1: Retrieve the Option Bytes configuration, which contains the RDP level
+    uint8 Local_u8Message;
+    FLASH_OBProgramInitTypeDef Local_stConfig;
+    HAL_FLASHEx_OBGetConfig(&Local_stConfig);
+    Local_u8Message = Local_stConfig.RDPLevel;
+
+    // Step 2: Send the ACK and the Read Protection Level (1 byte)
+    SendReply((const uint8*)&Local_u8Message, 1);
+}
+
+/**
+ * @brief  This function validates the address sent by the host and performs a jump to it (if valid).
+ *         The only flash target is the application at FLASH_SECTOR2_BASE_ADDRESS, started through the
+ *         same checks and de-initialization as after the idle timeout. With RAM_APPLET_STATUS enabled,
+ *         addresses in the applet area are called through the applet ABI and return to the bootloader,
+ *         the applet result follows the address status as a second reply.
+ * 
+ * @param  Host_Buffer: A pointer to the received CBL_go_to_addr_frame.
+ */
+static void Bootloader_Jump_To_Address(uint8_t *Host_Buffer)
+{
+    uint8 Local_u8Message = ADDRESS_IS_INVALID;  // Initialize message to indicate invalid address
+
+    // Step 1: Retrieve the address to jump to from the frame descriptor
+    uint32 Local_u32Address = ((const CBL_go_to_addr_frame*)Host_Buffer)->Address;
+
+    #if (RAM_APPLET_STATUS == ENABLED)
+    // Step 2: Addresses inside the applet area are called through the applet ABI and return here
+    if ((Local_u32Address >= RAM_APPLET_START_ADDRESS) && (Local_u32Address <= RAM_APPLET_END_ADDRESS))
+    {
+        // Add +1 for Thumb mode, the applet receives the services table in R0
+        BL_AppletEntry Local_fpApplet = (BL_AppletEntry)(Local_u32Address + 1);
+
+        Local_u8Message = ADDRESS_IS_VALID;
+        SendReply((const uint8*)&Local_u8Message, 1);
+
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_RUNNING_RAM_APPLET, 0);
+        #endif
+
+        // Run the applet and report its 32-bit result in a second reply once it returns
+        uint32 Local_u32AppletResult = Local_fpApplet(&Global_stAppletServices);
+        SendReply((const uint8*)&Local_u32AppletResult, 4);
+    }
+    else
+    #endif
+    // Step 3: Only the application base is a valid target, and only an application that may be started
+    if ((Local_u32Address == FLASH_SECTOR2_BASE_ADDRESS) && Application_u8IsStartable())
+    {
+        Local_u8Message = ADDRESS_IS_VALID;  // Update message to indicate valid address
+
+        // Send the valid address acknowledgment to the host, JumbToUserApplication() flushes it before the jump
+        SendReply((const uint8*)&Local_u8Message, 1);
+
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_JUMPING_TO_ADDRESS, Local_u32Address);  // Optional debug message for jumping
+        #endif
+
+        // Step 4: Stop the links and start the application
+        JumbToUserApplication();
+    }
+    else
+    {
+        // Any other flash or SRAM address, or an application that is not verified
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_INVALID_ADDRESS, Local_u32Address);  // Optional debug message for invalid address
+        #endif
+        
+        // Send an invalid address acknowledgment to the host
+        SendReply((const uint8*)&Local_u8Message, 1);
+    }
+}
+
+/**
+ * @brief Erases the flash memory pages requested by the host and sends the erase status.
+ *
+ * @param Host_Buffer Pointer to the received CBL_flash_erase_frame:
+ *                    - PageNumber: Starting page number for the erase operation (CBL_FLASH_MASS_ERASE for mass erase).
+ *                    - NumberOfPages: Number of pages to erase.
+ */
+static void Bootloader_Erase_Flash(uint8_t *Host_Buffer) {
+    const CBL_flash_erase_frame* Local_pstFrame = (const CBL_flash_erase_frame*)Host_Buffer;
+
+    // Step 1: Erase the pages and record them in the update journal
+    uint8_t Local_u8Message = ErasePages(Local_pstFrame->PageNumber, Local_pstFrame->NumberOfPages);
+
+    // Step 2: Send the ACK and the result of the erase operation
+    SendReply((const uint8_t*)&Local_u8Message, 1);
+}
+
+
+/**
+ * @brief  This function writes data from the host to the flash memory of the device
+ *         and sends the write status.
+ * @param  Host_Buffer: Pointer to the received CBL_mem_write_frame.
+ * @retval None
+ */
+static void Bootloader_Memory_Write(uint8_t *Host_Buffer)
+{
+    // Step 1: Extract the target flash address from the frame descriptor
+    CBL_mem_write_frame* Local_pstFrame = (CBL_mem_write_frame*)Host_Buffer;
+    uint32 Local_u32Address = Local_pstFrame->Address;
+    uint8_t Local_u8Message = UNSUCCESSFUL_WRITE;
+
+    // Step 2: Write the data straight from the receive ring, the data must lie inside the frame
+    if (Local_pstFrame->DataLength <= (Local_pstFrame->Header.Length - CBL_MEM_WRITE_MIN_LENGTH))
+    {
+        Local_u8Message = MemoryWrite(Local_pstFrame->Data, Local_pstFrame->DataLength, Local_u32Address);
+    }
+
+    // Step 3: Send the ACK and the result of the flash write operation
+    SendReply((const uint8_t*)&Local_u8Message, 1);
+}
+
+/**
+ * @brief  This function writes a RAM applet sent by the host into the SRAM applet area.
+ *         It uses the same frame layout as the memory write command, the written code is
+ *         started later with the go to address command.
+ * @param  Host_Buffer: Pointer to the received CBL_mem_write_frame.
+ * @retval None
+ */
+static void Bootloader_Ram_Write(uint8_t *Host_Buffer)
+{
+    // Step 1: Extract the target SRAM address from the frame descriptor
+    CBL_mem_write_frame* Local_pstFrame = (CBL_mem_write_frame*)Host_Buffer;
+    uint8_t Local_u8Message = UNSUCCESSFUL_RAM_WRITE;
+
+    // Step 2: Copy the data into the applet area, the data must lie inside the frame
+    #if (RAM_APPLET_STATUS == ENABLED)
+    if (Local_pstFrame->DataLength <= (Local_pstFrame->Header.Length - CBL_MEM_WRITE_MIN_LENGTH))
+    {
+        Local_u8Message = WriteRam(Local_pstFrame->Data, Local_pstFrame->DataLength, Local_pstFrame->Address);
+    }
+    #else
+    (void)Local_pstFrame;  // Applets are off while unsigned code may not run
+    #endif
+
+    // Step 3: Send the ACK and the result of the write operation
+    SendReply((const uint8_t*)&Local_u8Message, 1);
+}
+
+/**
+ * @brief  Verifies the Ed25519 signature of the application image and marks it bootable.
+ * @param  Host_Buffer: Pointer to the received CBL_verify_image_frame.
+ * @retval None
+ */
+static void Bootloader_Verify_Image(uint8_t *Host_Buffer)
+{
+    // Step 1: Extract the image length and check the signature
+    const CBL_verify_image_frame* Local_pstFrame = (const CBL_verify_image_frame*)Host_Buffer;
+    uint8_t Local_u8Message = VerifyImage(Local_pstFrame->ImageLength, Local_pstFrame->Signature);
+
+    // Step 2: Send the ACK and the result of the verification
+    SendReply((const uint8_t*)&Local_u8Message, 1);
+}
+
+/**
+ * @brief  Selects whether memory write data is sent in plaintext or AES-128-CTR encrypted.
+ * @param  Host_Buffer: Pointer to the received CBL_set_encryption_frame.
+ * @retval None
+ */
+static void Bootloader_Set_Encryption(uint8_t *Host_Buffer)
+{
+    // Step 1: Apply the requested mode
+    const CBL_set_encryption_frame* Local_pstFrame = (const CBL_set_encryption_frame*)Host_Buffer;
+    uint8_t Local_u8Message = SetEncryptionMode(Local_pstFrame->Mode, Local_pstFrame->InitialCounter);
+
+    // Step 2: Send the ACK and the result
+    SendReply((const uint8_t*)&Local_u8Message, 1);
+}
+
+/**
+ * @brief  Reports how far an update got so a reconnecting host can resume it.
+ *         The reply holds the resume offset from FLASH_SECTOR2_BASE_ADDRESS (4 bytes) followed by
+ *         a PAGE_state byte and the hardware CRC of every application page.
+ * @param  Host_Buffer: Pointer to the received frame.
+ * @retval None
+ */
+static void Bootloader_Get_Page_State(uint8_t *Host_Buffer)
+{
+    uint8 Local_u8arrReply[PAGE_STATE_REPLY_SIZE];
+    uint16 Local_u16ReplySize = 0;
+
+    // Step 1: Scan the application region
+    Local_u16ReplySize = GetPageState(Local_u8arrReply);
+
+    // Step 2: Send the ACK with the reply size together with the reply
+    SendReply((const uint8*)Local_u8arrReply, (uint8)Local_u16ReplySize);
+}
+
+/**
+ * @brief  Runs a batch of erase, write, CRC check and jump operations carried by a single frame.
+ *
+ * The reply is one result byte per operation, announced in the ACK. Execution stops at the first
+ * failed operation and the remaining results are BATCH_OP_SKIPPED. A jump operation must be last,
+ * the jump is taken after the results are sent.
+ * @param  Host_Buffer: Pointer to the received CBL_batch_frame.
+ * @retval None
+ */
+static void Bootloader_Batch(uint8_t *Host_Buffer)
+{
+    const CBL_batch_frame* Local_pstFrame = (const CBL_batch_frame*)Host_Buffer;
+    uint8 Local_u8arrResults[BATCH_MAX_OPERATIONS];
+    uint32 Local_u32JumpAddress = 0;
+    uint16 Local_u16Count = Local_pstFrame->OperationCount;
+
+    // Step 1: Execute the operations
+    if (Local_u16Count > BATCH_MAX_OPERATIONS)
+    {
+        Local_u16Count = BATCH_MAX_OPERATIONS;
+    }
+    memset(Local_u8arrResults, BATCH_OP_SKIPPED, Local_u16Count);
+    RunBatch(Local_pstFrame, Local_u16Count, Local_u8arrResults, &Local_u32JumpAddress);
+
+    // Step 2: Send the ACK announcing the size of the result vector together with the results
+    SendReply((const uint8*)Local_u8arrResults, (uint8)Local_u16Count);
+
+    // Step 3: Take the jump requested by the last operation, RunBatch() only accepts the startable application
+    if (0u != Local_u32JumpAddress)
+    {
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_BATCH_JUMPING_TO_ADDRESS, Local_u32JumpAddress);
+        #endif
+
+        HAL_FLASH_Lock();
+        JumbToUserApplication();
+    }
+}
+
+/**
+ * @brief  Programs RDP, USER, DATA0/1 and WRP from one frame and resets once to load them.
+ *         The status is sent before the reset, the host reconnects afterwards.
+ * @param  Host_Buffer: Pointer to the received CBL_option_bytes_frame.
+ * @retval None
+ */
+static void Bootloader_Write_Option_Bytes(uint8_t *Host_Buffer)
+{
+    // Step 1: Erase and program the option bytes
+    uint8 Local_u8Message = WriteOptionBytes((const CBL_option_bytes_frame*)Host_Buffer);
+
+    // Step 2: Send the ACK and the status
+    SendReply((const uint8*)&Local_u8Message, 1);
+
+    // Step 3: Reload the option bytes, this resets the device
+    if (OPTION_BYTES_WRITTEN == Local_u8Message)
+    {
+        Global_pstActiveTransport->Flush();
+        HAL_FLASH_OB_Launch();
+    }
+}
+
+/**
+ * @brief  Write-protects (CBL_PROTECT_BOOTLOADER_CMD) or unprotects (CBL_UNPROTECT_BOOTLOADER_CMD) every
+ *         bootloader page in one option byte cycle. RDP, USER, DATA0/1 and the protection of the other
+ *         pages are kept. The status is sent before the device resets to load the option bytes.
+ * @param  Host_Buffer: Pointer to the received frame.
+ * @retval None
+ */
+static void Bootloader_Set_Bootloader_Protection(uint8_t *Host_Buffer)
+{
+    CBL_option_bytes_frame Local_stOptionBytes;
+    FLASH_OBProgramInitTypeDef Local_stConfig;
+
+    // Step 1: Start from the current option bytes
+    HAL_FLASHEx_OBGetConfig(&Local_stConfig);
+    Local_stOptionBytes.RdpLevel = Local_stConfig.RDPLevel;
+    Local_stOptionBytes.User = Local_stConfig.USERConfig;
+    Local_stOptionBytes.Data0 = (uint8)HAL_FLASHEx_OBGetUserData(OB_DATA_ADDRESS_DATA0);
+    Local_stOptionBytes.Data1 = (uint8)HAL_FLASHEx_OBGetUserData(OB_DATA_ADDRESS_DATA1);
+    Local_stOptionBytes.WrpMask = ~Local_stConfig.WRPPage;
+
+    // Step 2: Add or remove the bootloader page groups
+    if (CBL_PROTECT_BOOTLOADER_CMD == ((const CBL_frame_header*)Host_Buffer)->Command)
+    {
+        Local_stOptionBytes.WrpMask |= BOOTLOADER_WRP_GROUPS;
+    }
+    else
+    {
+        Local_stOptionBytes.WrpMask &= ~BOOTLOADER_WRP_GROUPS;
+    }
+
+    // Step 3: Program the option bytes and send the ACK and the status
+    uint8 Local_u8Message = WriteOptionBytes(&Local_stOptionBytes);
+    SendReply((const uint8*)&Local_u8Message, 1);
+
+    // Step 4: Reload the option bytes, this resets the device
+    if (OPTION_BYTES_WRITTEN == Local_u8Message)
+    {
+        Global_pstActiveTransport->Flush();
+        HAL_FLASH_OB_Launch();
+    }
+}
+
+/**
+ * @brief  Replaces the bootloader with the image the host staged at BOOTLOADER_STAGING_ADDRESS.
+ *         The staged image is checked against the CRC and the signature sent by the host, the status is sent, then
+ *         the updater copies the image from SRAM and resets the device into the new bootloader.
+ * @param  Host_Buffer: Pointer to the received CBL_update_bootloader_frame.
+ * @retval None
+ */
+static void Bootloader_Update_Bootloader(uint8_t *Host_Buffer)
+{
+    const CBL_update_bootloader_frame* Local_pstFrame = (const CBL_update_bootloader_frame*)Host_Buffer;
+    uint32 Local_u32Length = Local_pstFrame->ImageLength;
+    uint32 Local_u32Crc = Local_pstFrame->ImageCrc;
+
+    // Step 1: Check the staged image and its signature
+    uint8 Local_u8Message = CheckStagedBootloader(Local_u32Length, Local_u32Crc, Local_pstFrame->Signature);
+
+    // Step 2: Send the ACK and the status
+    SendReply((const uint8*)&Local_u8Message, 1);
+
+    // Step 3: Hand over to the updater, it resets the device when done
+    if (BOOTLOADER_UPDATE_STARTED == Local_u8Message)
+    {
+        Global_pstActiveTransport->Flush();
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vFlush();  // The updater runs with interrupts disabled
+        #endif
+        RunUpdater(Local_u32Length, Local_u32Crc);
+    }
+}
+
+#if (TRACE_STATUS == ENABLED)
+/**
+ * @brief  Reports the phase timing histograms of one command.
+ *         The reply holds the core clock in Hz (4 bytes) followed by a TRACE_phase_stats record per
+ *         TRACE_phase: the total cycles (4 bytes) and TRACE_BUCKET_COUNT frame counts (2 bytes each).
+ *         Command codes outside the table report zeros.
+ * @param  Host_Buffer: Pointer to the received frame.
+ * @retval None
+ */
+static void Bootloader_Get_Trace(uint8_t *Host_Buffer)
+{
+    const CBL_get_trace_frame* Local_pstFrame = (const CBL_get_trace_frame*)Host_Buffer;
+    uint8 Local_u8arrReply[TRACE_REPLY_SIZE] = {0};
+    TRACE_command_stats* Local_pstStats = NULL;
+
+    // Step 1: Look up the statistics of the requested command
+    if ((Local_pstFrame->TraceCommand >= CBL_FIRST_CMD) && (Local_pstFrame->TraceCommand <= CBL_LAST_CMD))
+    {
+        Local_pstStats = &Global_starrTrace[Local_pstFrame->TraceCommand - CBL_FIRST_CMD];
+        memcpy(&Local_u8arrReply[4], Local_pstStats, sizeof(TRACE_command_stats));
+    }
+    memcpy(Local_u8arrReply, (const void*)&SystemCoreClock, 4);
+
+    // Step 2: Send the ACK and the reply
+    SendReply((const uint8*)Local_u8arrReply, TRACE_REPLY_SIZE);
+
+    // Step 3: Start a new measurement if requested
+    if ((NULL != Local_pstStats) && (0u != Local_pstFrame->Clear))
+    {
+        memset(Local_pstStats, 0, sizeof(TRACE_command_stats));
+    }
+}
+#endif
+
+/**
+ * @brief  Changes the Read-Out Protection (ROP) level requested by the host and sends the status.
+ * @param  Host_Buffer: Pointer to the received CBL_change_rop_frame.
+ * @retval None
+ */
+static void Bootloader_Change_Read_Protection_Level(uint8_t *Host_Buffer)
+{
+    // Step 1: Change the ROP level based on the data from the host
+    uint8 Local_u8Message = ChangeROPLevel(((const CBL_change_rop_frame*)Host_Buffer)->RopLevel);  // Pass the ROP level from the frame
+
+    // Step 2: Send the ACK and the status of ROP change operation
+    SendReply((const uint8*)&Local_u8Message, 1);
+}
+
+/**
+ * @brief  Writes one numbered block of a broadcast update and records it in the session bitmap.
+ *         Sent on the CAN broadcast ID the frame reaches every node and is not answered, a node that
+ *         missed it reports the block in its gap report and gets it again with a physical request.
+ * @param  Host_Buffer: Pointer to the received CBL_broadcast_write_frame.
+ * @retval None
+ */
+static void Bootloader_Broadcast_Write(uint8_t *Host_Buffer)
+{
+    CBL_broadcast_write_frame* Local_pstFrame = (CBL_broadcast_write_frame*)Host_Buffer;
+    uint16 Local_u16Block = Local_pstFrame->Block;
+    uint8_t Local_u8Message = UNSUCCESSFUL_WRITE;
+
+    // Step 1: A new session starts with no block written
+    if (Local_pstFrame->Session != Global_u8BroadcastSession)
+    {
+        memset(Global_u8arrBroadcastBlocks, 0, sizeof(Global_u8arrBroadcastBlocks));
+        Global_u8BroadcastSession = Local_pstFrame->Session;
+    }
+
+    // Step 2: Write the data like a memory write, the data must lie inside the frame
+    if ((Local_u16Block < BROADCAST_MAX_BLOCKS) &&
+        (Local_pstFrame->DataLength <= (Local_pstFrame->Header.Length - CBL_BROADCAST_WRITE_MIN_LENGTH)))
+    {
+        Local_u8Message = MemoryWrite(Local_pstFrame->Data, Local_pstFrame->DataLength, Local_pstFrame->Address);
+    }
+
+    // Step 3: Only a block that reached flash is taken off the gap report
+    if (SUCCESSFUL_WRITE == Local_u8Message)
+    {
+        Global_u8arrBroadcastBlocks[Local_u16Block >> 3] |= (uint8)(1u << (Local_u16Block & 7u));
+    }
+
+    // Step 4: Send the ACK and the result, dropped by the CAN link when the frame was broadcast
+    SendReply((const uint8_t*)&Local_u8Message, 1);
+}
+
+/**
+ * @brief  Reports which blocks of a broadcast session this node did not write.
+ *         The reply holds the number of missing blocks below BlockCount (2 bytes) followed by up to
+ *         GAP_REPORT_MAX_ENTRIES missing block numbers (2 bytes each) from FirstBlock on, the ACK size
+ *         tells the host how many follow. A node that never saw the session reports every block.
+ * @param  Host_Buffer: Pointer to the received CBL_get_gap_report_frame.
+ * @retval None
+ */
+static void Bootloader_Get_Gap_Report(uint8_t *Host_Buffer)
+{
+    const CBL_get_gap_report_frame* Local_pstFrame = (const CBL_get_gap_report_frame*)Host_Buffer;
+    uint8 Local_u8arrReply[GAP_REPORT_REPLY_SIZE];
+    uint8 Local_u8Known = (uint8)(Local_pstFrame->Session == Global_u8BroadcastSession);
+    uint16 Local_u16BlockCount = Local_pstFrame->BlockCount;
+    uint16 Local_u16FirstBlock = Local_pstFrame->FirstBlock;
+    uint16 Local_u16Missing = 0;
+    uint16 Local_u16ReplySize = 2u;
+    uint16 Local_u16Block = 0;
+
+    // Step 1: Collect the blocks without a bit in the session bitmap
+    if (Local_u16BlockCount > BROADCAST_MAX_BLOCKS)
+    {
+        Local_u16BlockCount = BROADCAST_MAX_BLOCKS;
+    }
+    for (Local_u16Block = 0; Local_u16Block < Local_u16BlockCount; Local_u16Block++)
+    {
+        if (!Local_u8Known || (0u == (Global_u8arrBroadcastBlocks[Local_u16Block >> 3] & (1u << (Local_u16Block & 7u)))))
+        {
+            Local_u16Missing++;
+            if ((Local_u16Block >= Local_u16FirstBlock) && (Local_u16ReplySize < GAP_REPORT_REPLY_SIZE))
+            {
+                Local_u8arrReply[Local_u16ReplySize] = (uint8)Local_u16Block;
+                Local_u8arrReply[Local_u16ReplySize + 1u] = (uint8)(Local_u16Block >> 8);
+                Local_u16ReplySize += 2u;
+            }
+        }
+    }
+    Local_u8arrReply[0] = (uint8)Local_u16Missing;
+    Local_u8arrReply[1] = (uint8)(Local_u16Missing >> 8);
+
+    // Step 2: Send the ACK with the reply size together with the reply
+    SendReply((const uint8*)Local_u8arrReply, (uint8)Local_u16ReplySize);
+}
+
+/**
+ * @brief  Reports the frame error counters of the link the request arrived on, so the host can size
+ *         its frames for the error rate of that link. The reply is a LINK_stats record: passed and
+ *         failed frames, then the bytes of each (4 bytes each). The request itself is already counted.
+ * @param  Host_Buffer: Pointer to the received CBL_get_link_stats_frame.
+ * @retval None
+ */
+static void Bootloader_Get_Link_Stats(uint8_t *Host_Buffer)
+{
+    // Step 1: Send the ACK and the counters
+    SendReply((const uint8*)Global_pstActiveLinkStats, LINK_STATS_REPLY_SIZE);
+
+    // Step 2: Start a new measurement if requested
+    if (0u != ((const CBL_get_link_stats_frame*)Host_Buffer)->Clear)
+    {
+        memset(Global_pstActiveLinkStats, 0, sizeof(LINK_stats));
+    }
+}
+
+
+#if (FEC_STATUS == ENABLED)
+/**
+ * @brief  Selects the number of Reed-Solomon parity bytes the host appends to every following frame.
+ *         The size must be even (it corrects half as many byte errors) and at most FEC_MAX_PARITY_SIZE,
+ *         0 turns FEC off. This frame and its reply still use the previous setting.
+ * @param  Host_Buffer: Pointer to the received CBL_set_fec_frame.
+ * @retval None
+ */
+static void Bootloader_Set_Fec(uint8_t *Host_Buffer)
+{
+    uint8 Local_u8ParitySize = ((const CBL_set_fec_frame*)Host_Buffer)->ParitySize;
+    uint8 Local_u8Message = FEC_MODE_INVALID;
+
+    // Step 1: Apply the parity size if the decoder supports it
+    if ((0u == (Local_u8ParitySize & 1u)) && (Local_u8ParitySize <= FEC_MAX_PARITY_SIZE))
+    {
+        Global_u8FecParitySize = Local_u8ParitySize;
+        Local_u8Message = FEC_MODE_SET;
+    }
+
+    // Step 2: Send the ACK and the result
+    SendReply((const uint8*)&Local_u8Message, 1);
+}
+
+/**
+ * @brief  Corrects a frame in place with the Reed-Solomon parity behind its CRC, then removes the
+ *         parity from the length byte, so the frame reads as if it was sent without FEC.
+ *
+ * The codeword is the whole frame, length byte (counting the parity) included, so a frame holds at
+ * most FEC_MAX_CODEWORD_SIZE bytes. A frame that cannot be corrected is left as received and fails
+ * the CRC check; one too short to carry the parity gets length 0 and is rejected as too short.
+ * @param  Frame: Pointer to the length byte of the frame.
+ * @retval None
+ */
+static void CorrectFrame(uint8* Frame)
+{
+    uint8 Local_u8Corrected = FEC_u8Decode(Frame, (uint16)Frame[0] + 1u, Global_u8FecParitySize);
+
+    if ((FEC_UNCORRECTABLE != Local_u8Corrected) && (0u != Local_u8Corrected))
+    {
+        Global_pstActiveLinkStats->BytesCorrected += Local_u8Corrected;
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_FEC_CORRECTED, Local_u8Corrected);
+        #endif
+    }
+
+    Frame[0] = (Frame[0] > Global_u8FecParitySize) ? (uint8)(Frame[0] - Global_u8FecParitySize) : 0u;
+}
+#endif
+
+/**
+ * @brief  Verifies the CRC (Cyclic Redundancy Check) of data received from the host.
+ * 
+ * This function calculates the CRC for the data received in the `Host_Buffer` and compares it 
+ * to the CRC sent by the host (appended at the end of the data). The size of the data, including
+ * the CRC, is determined by the first byte of the `Host_Buffer`.
+ * 
+ * @param  Host_Buffer: A pointer to the buffer containing the received data and the appended CRC.
+ * @retval CRC_status: Returns PASSED if the calculated CRC matches the host's CRC, otherwise FAILED.
+ */
+static CRC_status CRC_enVerify(const uint8 *Host_Buffer)
+{
+    // Initialize status as PASSED
+    CRC_status Local_enStatus = PASSED;
+
+    // Calculate the total length of data, including CRC
+    uint16 Local_u16DataLength = (uint16)Host_Buffer[0] + 1u; 
+
+    // Extract the CRC value sent by the host from the frame (last 4 bytes, not aligned in the receive ring)
+    uint32 Local_u32HostCrc = __UNALIGNED_UINT32_READ(Host_Buffer + Local_u16DataLength - CRC_SIZE); 
+
+    // Calculate the CRC over the frame (excluding the CRC itself), the engine is reset afterwards
+    BL_TRACE_START(TRACE_PHASE_CRC);
+    uint32 Local_u32McuCrc = CalculateCrc(Host_Buffer, Local_u16DataLength - CRC_SIZE);
+    BL_TRACE_STOP(TRACE_PHASE_CRC);
+
+    // Compare the CRC received from the host with the one calculated by MCU
+    if (Local_u32HostCrc != Local_u32McuCrc)
+    {
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_CRC_FAILED, 0); // Print debug message if CRC check fails
+        #endif
+        Local_enStatus = FAILED; // Mark status as failed
+        Global_pstActiveLinkStats->FramesFailed++;
+        Global_pstActiveLinkStats->BytesFailed += Local_u16DataLength;
+    }
+    else
+    {
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_CRC_PASSED, 0); // Print debug message if CRC check passes
+        #endif
+        Global_pstActiveLinkStats->FramesPassed++;
+        Global_pstActiveLinkStats->BytesPassed += Local_u16DataLength;
+    }
+
+    return Local_enStatus; // Return the CRC status
+}
+
+/**
+ * @brief  Sends the reply of a command as one integrity-checked frame: the acknowledgment byte (ACK),
+ *         a size byte announcing the length of the payload, the payload, then the protocol CRC over
+ *         the ACK, the size and the payload.
+ * 
+ * The three parts are handed to the active transport as one gather-send, which assembles them in
+ * its transmit buffer (the DMA source buffer of the UART, the staging buffer of USB and CAN), so
+ * every reply costs a single transmission.
+ * 
+ * @param  Payload: Pointer to the reply payload.
+ * @param  Copy_u8Length: Number of payload bytes.
+ * @retval None
+ */
+static void SendReply(const uint8* Payload, uint8 Copy_u8Length)
+{
+    uint8 Local_u8arrHeader[2] = {ACK, Copy_u8Length};
+    uint32 Local_u32Crc = 0;
+    TRANSPORT_segment Local_starrSegments[3] =
+    {
+        { Local_u8arrHeader, sizeof(Local_u8arrHeader) },
+        { Payload, Copy_u8Length },
+        { (const uint8*)&Local_u32Crc, CRC_SIZE },
+    };
+
+    BL_TRACE_START(TRACE_PHASE_REPLY);
+    FeedCrc(Local_u8arrHeader, sizeof(Local_u8arrHeader));
+    Local_u32Crc = CalculateCrc(Payload, Copy_u8Length);
+    Global_pstActiveTransport->SendGather(Local_starrSegments, 3u);
+    BL_TRACE_STOP(TRACE_PHASE_REPLY);
+}
+
+/**
+ * @brief  Sends a negative acknowledgment (NACK) message to the host.
+ * 
+ * This function sends a negative acknowledgment (NACK) to indicate that the received data 
+ * was not processed correctly. The message is sent on the active transport using SendData.
+ * 
+ * @retval None
+ */
+static void SendNAck()
+{
+    uint8 Local_u8Message = NACK;
+
+    // Send a negative acknowledgment (NACK) message
+    SendData((const uint8*)&Local_u8Message, 1);
+}
+
+/**
+ * @brief Erases specified flash memory pages.
+ *
+ * This function can perform either a mass erase of the entire flash memory or erase a specified number of pages.
+ * The flash must be unlocked by the caller (commands flagged CBL_FLAG_NEEDS_UNLOCK).
+ *
+ * @param Copy_u32PageAddress The starting address of the page to erase or a predefined constant for mass erase.
+ * @param Copy_u32NumberOfPages The number of pages to erase (only applicable if not performing a mass erase).
+ *
+ * @return FLASH_status Status of the erase operation:
+ *         - SUCCESSFUL_ERASE: Erase operation was successful.
  *         - UNSUCCESSFUL_ERASE: Erase operation failed.
  *         - INVALID_PAGE_NUMBER: The specified page number is invalid.
  *         - INVALID_PAGE_ADDRESS: The specified page address is invalid.
  */
-static FLASH_erase_status EraseFlashPages(uint32_t Copy_u32PageAddress, uint32_t Copy_u32NumberOfPages) {
-    HAL_StatusTypeDef Local_enFlashstatus = HAL_OK; // Status of HAL flash operations
-    FLASH_erase_status Local_enStatus = SUCCESSFUL_ERASE;  // Initialize status to successful erase
-    uint32_t Local_u32FaultyPageAddress;             // Variable to store faulty page address during erase
+static FLASH_erase_status EraseFlashPages(uint32_t Copy_u32PageAddress, uint32_t Copy_u32NumberOfPages) {
+    HAL_StatusTypeDef Local_enFlashstatus = HAL_OK; // Status of HAL flash operations
+    FLASH_erase_status Local_enStatus = SUCCESSFUL_ERASE;  // Initialize status to successful erase
+    uint32_t Local_u32FaultyPageAddress;             // Variable to store faulty page address during erase
+
+    // Refuse write-protected pages before anything is erased
+    if (Flash_u8IsWriteProtected(Copy_u32PageAddress, Copy_u32NumberOfPages * PAGE_SIZE)) {
+        Local_enStatus = ERASE_PAGE_PROTECTED;
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_ERASE_PAGE_PROTECTED, 0);
+        #endif
+    }
+    // Check if a mass erase is requested
+    else if (Copy_u32PageAddress == CBL_FLASH_MASS_ERASE) {
+        FLASH_EraseInitTypeDef Local_stFlashConfig;
+        Local_stFlashConfig.TypeErase = FLASH_TYPEERASE_MASSERASE; // Set erase type to mass erase
+        Local_stFlashConfig.Banks = FLASH_BANK_1;                  // Select flash bank to erase
+        BL_WATCHDOG_REFRESH();                                     // One erase cycle (40 ms at most)
+        BL_TRACE_START(TRACE_PHASE_ERASE);
+        Local_enFlashstatus = HAL_FLASHEx_Erase(&Local_stFlashConfig, (uint32_t*)&Local_u32FaultyPageAddress); // Perform mass erase
+        BL_TRACE_STOP(TRACE_PHASE_ERASE);
+
+        // Check if the mass erase was successful
+        if ((Local_enFlashstatus == HAL_OK) && (Local_u32FaultyPageAddress == 0xFFFFFFFF)) {
+            Local_enStatus = SUCCESSFUL_ERASE; // Mass erase successful
+            #if (DEBUG_STATUS == ENABLED)
+            Log_vWrite(LOG_SUCCESSFUL_MASS_ERASE, 0); // Print debug message for successful erase
+            #endif
+        } else {
+            Local_enStatus = UNSUCCESSFUL_ERASE; // Mass erase failed
+            #if (DEBUG_STATUS == ENABLED)
+            Log_vWrite(LOG_UNSUCCESSFUL_MASS_ERASE, 0); // Print debug message for unsuccessful erase
+            #endif
+        }
+    }
+    // Check if the passed address is valid for page erase
+    else if ((Copy_u32PageAddress >= FLASH_BASE_ADDRESS) && (Copy_u32PageAddress <= FLASH_LAST_ADDRESS) && (Copy_u32PageAddress % PAGE_SIZE == 0)) {
+        // Check if the requested number of pages does not exceed the flash memory limit
+        if ((Copy_u32PageAddress + (Copy_u32NumberOfPages - 1) * PAGE_SIZE) <= FLASH_LAST_ADDRESS) {
+            FLASH_EraseInitTypeDef Local_stFlashConfig;
+            uint32_t Local_u32Page = 0;
+            Local_stFlashConfig.TypeErase = FLASH_TYPEERASE_PAGES; // Set erase type to page erase
+            Local_stFlashConfig.NbPages = 1;                       // One page per call, the watchdog is refreshed in between
+            Local_u32FaultyPageAddress = 0xFFFFFFFF;
+            BL_TRACE_START(TRACE_PHASE_ERASE);
+            for (Local_u32Page = 0; (Local_enFlashstatus == HAL_OK) && (Local_u32FaultyPageAddress == 0xFFFFFFFF) && (Local_u32Page < Copy_u32NumberOfPages); Local_u32Page++) {
+                Local_stFlashConfig.PageAddress = Copy_u32PageAddress + (Local_u32Page * PAGE_SIZE);
+                Local_enFlashstatus = HAL_FLASHEx_Erase(&Local_stFlashConfig, (uint32_t*)&Local_u32FaultyPageAddress); // Perform page erase
+                BL_WATCHDOG_REFRESH();
+            }
+            BL_TRACE_STOP(TRACE_PHASE_ERASE);
+
+            // Check if the page erase was successful
+            if ((Local_enFlashstatus == HAL_OK) && (Local_u32FaultyPageAddress == 0xFFFFFFFF)) {
+                Local_enStatus = SUCCESSFUL_ERASE; // Page erase successful
+                #if (DEBUG_STATUS == ENABLED)
+                Log_vWrite(LOG_SUCCESSFUL_ERASE, 0); // Print debug message for successful erase
+                #endif
+            } else {
+                Local_enStatus = UNSUCCESSFUL_ERASE; // Page erase failed
+                #if (DEBUG_STATUS == ENABLED)
+                Log_vWrite(LOG_UNSUCCESSFUL_ERASE, 0); // Print debug message for unsuccessful erase
+                #endif
+            }
+        } else {
+            Local_enStatus = INVALID_PAGE_NUMBER; // Requested number of pages exceeds memory limit
+            #if (DEBUG_STATUS == ENABLED)
+            Log_vWrite(LOG_INVALID_PAGE_NUMBER, 0); // Print debug message for invalid page number
+            #endif
+        }
+    } else {
+        Local_enStatus = INVALID_PAGE_ADDRESS; // Invalid page address provided
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_INVALID_PAGE_ADDRESS, 0); // Print debug message for invalid page address
+        #endif
+    }
+
+    return Local_enStatus; // Return the status of the erase operation
+}
+
+/**
+ * @brief  This function writes data to flash memory in 16-bit half-word units.
+ *         The start address must be even. With an odd length the last half-word holds the last byte
+ *         and 0xFF, the erased value, in place of the byte behind the data.
+ *         The function performs boundary checks and writes the data, the flash must be unlocked
+ *         by the caller (commands flagged CBL_FLAG_NEEDS_UNLOCK).
+ * @param  Host_Buffer: Pointer to the buffer holding the data to be written to flash memory.
+ * @param  Copy_u8Length: The length of the data to be written in bytes.
+ * @param  Copy_u32StartAddress: The starting address in flash memory where data will be written.
+ * @retval FLASH_write_status: Returns SUCCESSFUL_WRITE if successful, otherwise UNSUCCESSFUL_WRITE.
+ */
+static FLASH_write_status WriteFlash(uint8* Host_Buffer, uint8 Copy_u8Length, uint32 Copy_u32StartAddress)
+{
+    // Status variable to indicate if the write operation was successful or not.
+    FLASH_write_status Local_stErrState = SUCCESSFUL_WRITE;
+    // Status variable to track the result of HAL flash operations.
+    HAL_StatusTypeDef Local_enFlashstatus = HAL_OK;
+
+    // Refuse write-protected pages before anything is programmed
+    if (Flash_u8IsWriteProtected(Copy_u32StartAddress, Copy_u8Length))
+    {
+        Local_stErrState = WRITE_PAGE_PROTECTED;
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_WRITE_PAGE_PROTECTED, 0);
+        #endif
+    }
+    // Check if the start address is a half-word address within the valid flash memory range
+    // and if the total length of data to write fits within the allowed address range.
+    else if (((Copy_u32StartAddress) >= FLASH_BASE_ADDRESS) && (0u == (Copy_u32StartAddress & 1u)) &&
+        ((Copy_u32StartAddress + Copy_u8Length) <= FLASH_LAST_ADDRESS))
+    {
+        uint16 Local_u16Counter = 0;   // Counter for iterating through the buffer
+        uint16 Local_u16Data = 0;      // Temporary variable to hold 16-bit data
+
+        BL_TRACE_START(TRACE_PHASE_PROGRAM);
+
+        // Program two bytes at a time. The half-words are built from byte loads, as the data sits at
+        // any alignment inside the receive buffer
+        for (Local_u16Counter = 0; ((Local_enFlashstatus == HAL_OK) && ((Local_u16Counter + 1u) < Copy_u8Length)); Local_u16Counter += 2)
+        {
+            Local_u16Data = (uint16)(Host_Buffer[Local_u16Counter] | (Host_Buffer[Local_u16Counter + 1u] << 8));
+            Local_enFlashstatus = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, Copy_u32StartAddress + Local_u16Counter, Local_u16Data);
+        }
+
+        // An odd last byte is programmed at its own (even) address, padded with the erased value 0xFF
+        // instead of reading past the end of the data
+        if ((Local_enFlashstatus == HAL_OK) && (Local_u16Counter < Copy_u8Length))
+        {
+            Local_u16Data = (uint16)(Host_Buffer[Local_u16Counter] | 0xFF00u);
+            Local_enFlashstatus = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, Copy_u32StartAddress + Local_u16Counter, Local_u16Data);
+        }
+        BL_WATCHDOG_REFRESH();  // A full frame programs in about 9 ms
+
+        BL_TRACE_STOP(TRACE_PHASE_PROGRAM);
+
+        // Check if the entire flash write operation was successful
+        if (HAL_OK == Local_enFlashstatus)
+        {
+            Local_stErrState = SUCCESSFUL_WRITE;  // Mark the operation as successful
+            #if (DEBUG_STATUS == ENABLED)
+            Log_vWrite(LOG_SUCCESSFUL_WRITE, 0);  // Debug message indicating successful write
+            #endif
+        }
+        else
+        {
+            Local_stErrState = UNSUCCESSFUL_WRITE;  // Mark the operation as failed
+            #if (DEBUG_STATUS == ENABLED)
+            Log_vWrite(LOG_UNSUCCESSFUL_WRITE, 0);  // Debug message indicating failure in writing
+            #endif
+        }
+    }
+    else
+    {
+        // If the start address or address range is invalid, return error status
+        Local_stErrState = UNSUCCESSFUL_WRITE;
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_INVALID_FLASH_ADDRESS, Copy_u32StartAddress);  // Debug message indicating invalid flash address range
+        #endif
+    }
+
+    // Return the final status of the flash write operation
+    return Local_stErrState;
+}
+
+
+
+/**
+ * @brief  Erases pages given by page number and records erased application pages in the update journal.
+ *         Only pages of the application region can be erased by the host, a mass erase is refused.
+ * @param  Copy_u8PageNumber: First page to erase, CBL_FLASH_MASS_ERASE for a mass erase.
+ * @param  Copy_u8NumberOfPages: Number of pages to erase.
+ * @retval FLASH_erase_status: Result of EraseFlashPages, ERASE_PAGE_RESERVED outside the application region.
+ */
+static FLASH_erase_status ErasePages(uint8 Copy_u8PageNumber, uint8 Copy_u8NumberOfPages)
+{
+    // Convert the page number to its address, CBL_FLASH_MASS_ERASE is passed through
+    uint32 Local_u32PageAddress = Copy_u8PageNumber;
+    FLASH_erase_status Local_enStatus = ERASE_PAGE_RESERVED;
+    if (Local_u32PageAddress != CBL_FLASH_MASS_ERASE)
+    {
+        Local_u32PageAddress = FLASH_BASE_ADDRESS + (Local_u32PageAddress * PAGE_SIZE);
+    }
+
+    // The bootloader, the journal, the version counter and the image record are not the host's to erase
+    if (Flash_u8IsReserved(Local_u32PageAddress, (uint32)Copy_u8NumberOfPages * PAGE_SIZE))
+    {
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_ERASE_PAGE_RESERVED, 0);
+        #endif
+        return Local_enStatus;
+    }
+
+    Local_enStatus = EraseFlashPages(Local_u32PageAddress, Copy_u8NumberOfPages);
+
+    // Record the erased application pages in the update journal
+    if (SUCCESSFUL_ERASE == Local_enStatus)
+    {
+        Journal_vRecordErase(Local_u32PageAddress, Copy_u8NumberOfPages);
+    }
+
+    return Local_enStatus;
+}
+
+/**
+ * @brief  Writes a block received from the host to flash.
+ *         In encrypted mode the data is decrypted in place first. Written data is fed into the
+ *         image hash while it is still in the receive ring, and completed pages are committed
+ *         to the update journal.
+ * @param  Data: Pointer to the data in the receive ring.
+ * @param  Copy_u8Length: The length of the data in bytes.
+ * @param  Copy_u32Address: The flash address where the data will be written.
+ * @retval FLASH_write_status: SUCCESSFUL_WRITE if the data was decrypted and written, WRITE_PAGE_RESERVED
+ *         if the range leaves the application region.
+ */
+static FLASH_write_status MemoryWrite(uint8* Data, uint8 Copy_u8Length, uint32 Copy_u32Address)
+{
+    FLASH_write_status Local_enStatus = WRITE_PAGE_RESERVED;
+
+    // Only the application region is written on behalf of the host
+    if (Flash_u8IsReserved(Copy_u32Address, Copy_u8Length))
+    {
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_WRITE_PAGE_RESERVED, Copy_u32Address);
+        #endif
+        return Local_enStatus;
+    }
+
+    Local_enStatus = DecryptFrame(Data, Copy_u8Length, Copy_u32Address);
+
+    if (SUCCESSFUL_WRITE == Local_enStatus)
+    {
+        Journal_vResumeWrite(Copy_u32Address);
+        Local_enStatus = WriteFlash(Data, Copy_u8Length, Copy_u32Address);
+    }
+
+    if (SUCCESSFUL_WRITE == Local_enStatus)
+    {
+        Image_vTrackWrite(Data, Copy_u8Length, Copy_u32Address);
+        Journal_vRecordWrite(Copy_u32Address, Copy_u8Length);
+    }
+
+    return Local_enStatus;
+}
+
+/**
+ * @brief  Executes the operations of a batch frame until one fails.
+ *         Every operation is bounds-checked against the end of the frame before it is decoded.
+ * @param  Copy_pstFrame: Pointer to the batch frame in the receive ring.
+ * @param  Copy_u16Count: Number of operations to run, at most BATCH_MAX_OPERATIONS.
+ * @param  Copy_pu8Results: Result vector, one byte per operation, pre-filled with BATCH_OP_SKIPPED.
+ * @param  Copy_pu32JumpAddress: Set to the jump target when the batch ends with a valid jump, otherwise left at 0.
+ * @retval uint16: Number of operations that were executed.
+ */
+static uint16 RunBatch(const CBL_batch_frame* Copy_pstFrame, uint16 Copy_u16Count, uint8* Copy_pu8Results, uint32* Copy_pu32JumpAddress)
+{
+    const uint8* Local_pu8Op = Copy_pstFrame->Operations;
+    const uint8* Local_pu8End = (const uint8*)Copy_pstFrame + Copy_pstFrame->Header.Length + 1u - CRC_SIZE;
+    uint16 Local_u16Index = 0;
+    uint8 Local_u8Failed = 0;
+
+    for (Local_u16Index = 0; (Local_u16Index < Copy_u16Count) && (0u == Local_u8Failed); Local_u16Index++)
+    {
+        uint32 Local_u32Remaining = (uint32)(Local_pu8End - Local_pu8Op);
+        uint8 Local_u8Result = BATCH_OP_MALFORMED;
+
+        if ((Local_u32Remaining >= sizeof(CBL_batch_erase_op)) && (BATCH_OP_ERASE == Local_pu8Op[0]))
+        {
+            const CBL_batch_erase_op* Local_pstOp = (const CBL_batch_erase_op*)Local_pu8Op;
+
+            Local_u8Result = ErasePages(Local_pstOp->PageNumber, Local_pstOp->NumberOfPages);
+            Local_u8Failed = (SUCCESSFUL_ERASE != Local_u8Result);
+            Local_pu8Op += sizeof(CBL_batch_erase_op);
+        }
+        else if ((Local_u32Remaining >= sizeof(CBL_batch_write_op)) && (BATCH_OP_WRITE == Local_pu8Op[0]) &&
+                 ((Local_u32Remaining - sizeof(CBL_batch_write_op)) >= ((const CBL_batch_write_op*)Local_pu8Op)->DataLength))
+        {
+            CBL_batch_write_op* Local_pstOp = (CBL_batch_write_op*)Local_pu8Op;
+
+            Local_u8Result = MemoryWrite(Local_pstOp->Data, Local_pstOp->DataLength, Local_pstOp->Address);
+            Local_u8Failed = (SUCCESSFUL_WRITE != Local_u8Result);
+            Local_pu8Op += sizeof(CBL_batch_write_op) + Local_pstOp->DataLength;
+        }
+        else if ((Local_u32Remaining >= sizeof(CBL_batch_crc_op)) && (BATCH_OP_CRC_CHECK == Local_pu8Op[0]))
+        {
+            const CBL_batch_crc_op* Local_pstOp = (const CBL_batch_crc_op*)Local_pu8Op;
+
+            // Only ranges inside the flash are checked
+            Local_u8Result = FAILED;
+            if ((Local_pstOp->Address >= FLASH_BASE_ADDRESS) && (Local_pstOp->Length <= (FLASH_LAST_ADDRESS + 1u - FLASH_BASE_ADDRESS)) &&
+                ((Local_pstOp->Address - FLASH_BASE_ADDRESS) <= (FLASH_LAST_ADDRESS + 1u - FLASH_BASE_ADDRESS - Local_pstOp->Length)) &&
+                (Local_pstOp->Crc == CalculateCrc((const uint8*)Local_pstOp->Address, Local_pstOp->Length)))
+            {
+                Local_u8Result = PASSED;
+            }
+            Local_u8Failed = (PASSED != Local_u8Result);
+            Local_pu8Op += sizeof(CBL_batch_crc_op);
+        }
+        else if ((Local_u32Remaining >= sizeof(CBL_batch_jump_op)) && (BATCH_OP_JUMP == Local_pu8Op[0]))
+        {
+            const CBL_batch_jump_op* Local_pstOp = (const CBL_batch_jump_op*)Local_pu8Op;
+
+            // The jump ends the batch, it is taken by the caller once the results are sent. As with
+            // CBL_GO_TO_ADDR_CMD the only target is an application that may be started
+            Local_u8Result = ADDRESS_IS_INVALID;
+            if ((Local_pstOp->Address == FLASH_SECTOR2_BASE_ADDRESS) && Application_u8IsStartable())
+            {
+                Local_u8Result = ADDRESS_IS_VALID;
+                *Copy_pu32JumpAddress = Local_pstOp->Address;
+            }
+            Local_u8Failed = 1u;
+        }
+        else
+        {
+            // Unknown or truncated operation
+            Local_u8Failed = 1u;
+        }
+
+        Copy_pu8Results[Local_u16Index] = Local_u8Result;
+    }
+
+    return Local_u16Index;
+}
+
+/**
+ * @brief  Change the Read-Out Protection (ROP) level of the Flash memory.
+ *         This function updates the RDP level of the flash memory to the specified value
+ *         by unlocking the option bytes, modifying the RDP level, and locking the option bytes again.
+ * @param  Copy_u8ROPLevel: Desired ROP level to be set (0, 1, or 2).
+ * @retval FLASH_CHANGE_PROTECTION_status: ROP_LEVEL_CHANGE_VALID if the operation succeeds, 
+ *         ROP_LEVEL_CHANGE_INVALID if the operation fails at any step.
+ */
+static FLASH_CHANGE_PROTECTION_status ChangeROPLevel(uint8 Copy_u8ROPLevel)
+{
+    // Initialize status variables for flash operation and error state
+	HAL_StatusTypeDef Local_stFlashStatus = HAL_OK;
+	FLASH_CHANGE_PROTECTION_status Local_stErrState = ROP_LEVEL_CHANGE_VALID;
+
+    // Unlock option bytes to allow programming of ROP level
+	Local_stFlashStatus = HAL_FLASH_OB_Unlock();
+	if (Local_stFlashStatus == HAL_OK)
+	{
+		#if (DEBUG_STATUS == ENABLED)
+		Log_vWrite(LOG_SUCCESSFUL_OB_UNLOCK, 0);  // Debug message indicating successful option byte unlock
+		#endif
+
+        // Initialize the configuration structure for the option bytes
+		FLASH_OBProgramInitTypeDef Local_stFlashConfig;
+		Local_stFlashConfig.Banks = FLASH_BANK_1;  // Specify the flash bank
+		Local_stFlashConfig.OptionType = OPTIONBYTE_RDP;  // Specify that the RDP option is to be programmed
+		Local_stFlashConfig.RDPLevel = Copy_u8ROPLevel;  // Set the desired RDP level
+
+        // Program the RDP level into the option bytes
+		Local_stFlashStatus = HAL_FLASHEx_OBProgram(&Local_stFlashConfig);
+		if (Local_stFlashStatus == HAL_OK)
+		{
+			#if (DEBUG_STATUS == ENABLED)
+			Log_vWrite(LOG_SUCCESSFUL_ROP_CHANGE, 0);  // Debug message indicating successful ROP level change
+			#endif
+
+            // Launch the option byte programming operation
+			HAL_FLASH_OB_Launch();
+
+            // Lock the option bytes after the ROP level is changed
+			Local_stFlashStatus = HAL_FLASH_OB_Lock();
+			if (Local_stFlashStatus == HAL_OK)
+			{
+				#if (DEBUG_STATUS == ENABLED)
+				Log_vWrite(LOG_SUCCESSFUL_OB_LOCK, 0);  // Debug message indicating successful option byte lock
+				#endif
+			}
+			else
+			{
+				#if (DEBUG_STATUS == ENABLED)
+				Log_vWrite(LOG_UNSUCCESSFUL_OB_LOCK, 0);  // Debug message indicating failure in locking option bytes
+				#endif
+				Local_stErrState = ROP_LEVEL_CHANGE_INVALID;  // Error state if locking fails
+			}
+		}
+		else
+		{
+            // If ROP level programming fails, return error and lock option bytes
+			Local_stErrState = ROP_LEVEL_CHANGE_INVALID;
+			HAL_FLASH_OB_Lock();
+			#if (DEBUG_STATUS == ENABLED)
+			Log_vWrite(LOG_UNSUCCESSFUL_ROP_CHANGE, 0);  // Debug message indicating successful ROP level change
+			#endif
+		}
+	}
+	else
+	{
+		#if (DEBUG_STATUS == ENABLED)
+		Log_vWrite(LOG_UNSUCCESSFUL_OB_UNLOCK, 0);  // Debug message indicating failure in unlocking option bytes
+		#endif
+        // Error state if unlocking option bytes fails
+		Local_stErrState = ROP_LEVEL_CHANGE_INVALID;
+		HAL_FLASH_OB_Lock();  // Ensure option bytes are locked even if unlock fails
+	}
+
+	return Local_stErrState;  // Return the final error state of the operation
+}
+
+/**
+ * @brief  Replaces the whole option byte set with a single option byte erase.
+ *
+ * HAL_FLASHEx_OBProgram erases the option bytes again for every WRP or RDP change, which loses the
+ * other fields and needs one call (and one reset) per field. Here the option bytes are erased once
+ * and RDP, USER, DATA0, DATA1 and WRP0..3 are programmed directly, erased values are skipped.
+ * The flash must be unlocked by the caller, HAL_FLASH_OB_Launch is left to the caller.
+ * @param  Copy_pstOptionBytes: Pointer to the requested option byte values.
+ * @retval OPTION_BYTES_status: OPTION_BYTES_WRITTEN if every option byte was programmed.
+ */
+static OPTION_BYTES_status WriteOptionBytes(const CBL_option_bytes_frame* Copy_pstOptionBytes)
+{
+    OPTION_BYTES_status Local_enStatus = OPTION_BYTES_WRITE_FAILED;
+    HAL_StatusTypeDef Local_enFlashStatus = HAL_OK;
+    uint32 Local_u32WrpMask = Copy_pstOptionBytes->WrpMask;
+    uint8 Local_u8Index = 0;
+
+    // Option byte targets and values, a WRPx bit at 0 protects its page group
+    volatile uint16* const Local_pu16arrTargets[OPTION_BYTES_COUNT] =
+    {
+        &OB->RDP, &OB->USER, &OB->Data0, &OB->Data1, &OB->WRP0, &OB->WRP1, &OB->WRP2, &OB->WRP3
+    };
+    const uint8 Local_u8arrValues[OPTION_BYTES_COUNT] =
+    {
+        Copy_pstOptionBytes->RdpLevel,
+        (uint8)(Copy_pstOptionBytes->User | OPTION_USER_RESERVED_BITS),
+        Copy_pstOptionBytes->Data0,
+        Copy_pstOptionBytes->Data1,
+        (uint8)~Local_u32WrpMask,
+        (uint8)~(Local_u32WrpMask >> 8),
+        (uint8)~(Local_u32WrpMask >> 16),
+        (uint8)~(Local_u32WrpMask >> 24),
+    };
+
+    if ((OB_RDP_LEVEL_0 != Copy_pstOptionBytes->RdpLevel) && (OB_RDP_LEVEL_1 != Copy_pstOptionBytes->RdpLevel))
+    {
+        Local_enStatus = OPTION_BYTES_INVALID_RDP;
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_INVALID_RDP_LEVEL, Copy_pstOptionBytes->RdpLevel);
+        #endif
+    }
+    else
+    {
+        Local_enFlashStatus = HAL_FLASH_OB_Unlock();
+
+        // Step 1: Erase the option bytes once
+        if (HAL_OK == Local_enFlashStatus)
+        {
+            Local_enFlashStatus = FLASH_WaitForLastOperation(FLASH_TIMEOUT_VALUE);
+        }
+        if (HAL_OK == Local_enFlashStatus)
+        {
+            SET_BIT(FLASH->CR, FLASH_CR_OPTER);
+            SET_BIT(FLASH->CR, FLASH_CR_STRT);
+            Local_enFlashStatus = FLASH_WaitForLastOperation(FLASH_TIMEOUT_VALUE);
+            CLEAR_BIT(FLASH->CR, FLASH_CR_OPTER);
+        }
+
+        // Step 2: Program every option byte that differs from the erased value
+        if (HAL_OK == Local_enFlashStatus)
+        {
+            SET_BIT(FLASH->CR, FLASH_CR_OPTPG);
+            for (Local_u8Index = 0; (Local_u8Index < OPTION_BYTES_COUNT) && (HAL_OK == Local_enFlashStatus); Local_u8Index++)
+            {
+                if (OPTION_BYTE_ERASED != Local_u8arrValues[Local_u8Index])
+                {
+                    *Local_pu16arrTargets[Local_u8Index] = Local_u8arrValues[Local_u8Index];
+                    Local_enFlashStatus = FLASH_WaitForLastOperation(FLASH_TIMEOUT_VALUE);
+                }
+            }
+            CLEAR_BIT(FLASH->CR, FLASH_CR_OPTPG);
+        }
+
+        HAL_FLASH_OB_Lock();
+
+        if (HAL_OK == Local_enFlashStatus)
+        {
+            Local_enStatus = OPTION_BYTES_WRITTEN;
+            #if (DEBUG_STATUS == ENABLED)
+            Log_vWrite(LOG_SUCCESSFUL_OB_WRITE, 0);
+            #endif
+        }
+        else
+        {
+            #if (DEBUG_STATUS == ENABLED)
+            Log_vWrite(LOG_UNSUCCESSFUL_OB_WRITE, 0);
+            #endif
+        }
+    }
+
+    return Local_enStatus;
+}
+
+/**
+ * @brief  Checks a flash range against the WRP bitmap cached by BL_vInit.
+ * @param  Copy_u32Address: Start of the range, CBL_FLASH_MASS_ERASE checks the whole flash.
+ * @param  Copy_u32Length: Length of the range in bytes.
+ * @retval uint8: 1 if the range touches a write-protected page group, otherwise 0. Ranges outside
+ *         the flash are left to the range checks of the caller.
+ */
+static uint8 Flash_u8IsWriteProtected(uint32 Copy_u32Address, uint32 Copy_u32Length)
+{
+    uint8 Local_u8Protected = 0;
+
+    if (Copy_u32Address == CBL_FLASH_MASS_ERASE)
+    {
+        Local_u8Protected = (0u != Global_u32WrpProtectedGroups);
+    }
+    else if ((Copy_u32Address >= FLASH_BASE_ADDRESS) && (Copy_u32Address <= FLASH_LAST_ADDRESS) && (0u != Copy_u32Length))
+    {
+        uint32 Local_u32Last = Copy_u32Address + Copy_u32Length - 1u;
+        uint32 Local_u32Group = (Copy_u32Address - FLASH_BASE_ADDRESS) / WRP_GROUP_SIZE;
+        uint32 Local_u32LastGroup = 0;
+
+        // Clamp the end of the range to the flash, out of range lengths are rejected by the caller
+        if ((Local_u32Last < Copy_u32Address) || (Local_u32Last > FLASH_LAST_ADDRESS))
+        {
+            Local_u32Last = FLASH_LAST_ADDRESS;
+        }
+        Local_u32LastGroup = (Local_u32Last - FLASH_BASE_ADDRESS) / WRP_GROUP_SIZE;
+
+        for (; (Local_u32Group <= Local_u32LastGroup) && (0u == Local_u8Protected); Local_u32Group++)
+        {
+            Local_u8Protected = (0u != (Global_u32WrpProtectedGroups & (1uL << Local_u32Group)));
+        }
+    }
+
+    return Local_u8Protected;
+}
+
+/**
+ * @brief  Checks a range requested by the host against the application region.
+ *         Everything else in the flash belongs to the bootloader: its own region, the update journal,
+ *         the version counter and the image record. Only the bootloader itself writes them.
+ * @param  Copy_u32Address: Start of the range, CBL_FLASH_MASS_ERASE covers the whole flash.
+ * @param  Copy_u32Length: Length of the range in bytes.
+ * @retval uint8: 1 if the range is empty or leaves the application region, otherwise 0.
+ */
+static uint8 Flash_u8IsReserved(uint32 Copy_u32Address, uint32 Copy_u32Length)
+{
+    return (uint8)((Copy_u32Address == CBL_FLASH_MASS_ERASE) || (0u == Copy_u32Length) ||
+                   (Copy_u32Address < FLASH_SECTOR2_BASE_ADDRESS) || (Copy_u32Address > APPLICATION_END_ADDRESS) ||
+                   (Copy_u32Length > (APPLICATION_END_ADDRESS + 1u - Copy_u32Address)));
+}
+
+/**
+ * @brief  Checks that the staged bootloader image can be installed.
+ *         The CRC only proves the staged copy matches what the host sent, the signature proves the image
+ *         comes from the holder of the signing key. Both are checked before the updater runs.
+ * @param  Copy_u32Length: Length of the staged image in bytes.
+ * @param  Copy_u32Crc: Protocol CRC of the image sent by the host.
+ * @param  Copy_pu8Signature: Ed25519 signature over the SHA-256 digest of the staged image.
+ * @retval BOOTLOADER_update_status: BOOTLOADER_UPDATE_STARTED if the update can go ahead.
+ */
+static BOOTLOADER_update_status CheckStagedBootloader(uint32 Copy_u32Length, uint32 Copy_u32Crc, const uint8* Copy_pu8Signature)
+{
+    BOOTLOADER_update_status Local_enStatus = BOOTLOADER_UPDATE_STARTED;
+    SHA256_context Local_stHash;
+    uint8 Local_u8arrDigest[SHA256_DIGEST_SIZE];
+
+    if ((0u == Copy_u32Length) || (Copy_u32Length > BOOTLOADER_REGION_SIZE) ||
+        (Copy_u32Length > (APPLICATION_END_ADDRESS + 1u - BOOTLOADER_STAGING_ADDRESS)))
+    {
+        Local_enStatus = BOOTLOADER_UPDATE_INVALID_LENGTH;
+    }
+    else if (Flash_u8IsWriteProtected(FLASH_BASE_ADDRESS, Copy_u32Length))
+    {
+        Local_enStatus = BOOTLOADER_UPDATE_PROTECTED;
+    }
+    else if (Copy_u32Crc != CalculateCrc((const uint8*)BOOTLOADER_STAGING_ADDRESS, Copy_u32Length))
+    {
+        Local_enStatus = BOOTLOADER_UPDATE_CRC_MISMATCH;
+    }
+    else
+    {
+        SHA256_vInit(&Local_stHash);
+        SHA256_vUpdate(&Local_stHash, (const uint8*)BOOTLOADER_STAGING_ADDRESS, Copy_u32Length);
+        SHA256_vFinal(&Local_stHash, Local_u8arrDigest);
+
+        BL_WATCHDOG_REFRESH();
+        if (SIGNATURE_VALID != ED25519_enVerify(Copy_pu8Signature, Local_u8arrDigest, SHA256_DIGEST_SIZE, Global_u8arrSigningKey))
+        {
+            Local_enStatus = BOOTLOADER_UPDATE_SIGNATURE_INVALID;
+        }
+    }
+
+    #if (DEBUG_STATUS == ENABLED)
+    Log_vWrite(LOG_BOOTLOADER_UPDATE_STATUS, Local_enStatus);
+    #endif
+
+    return Local_enStatus;
+}
+
+/**
+ * @brief  Copies Updater_vRun into the applet area and starts it with interrupts disabled.
+ *         The flash must be unlocked by the caller. The updater does not return, it resets the device.
+ * @param  Copy_u32Length: Length of the staged image in bytes.
+ * @param  Copy_u32Crc: Protocol CRC of the image, checked again on the copy.
+ * @retval None
+ */
+static void RunUpdater(uint32 Copy_u32Length, uint32 Copy_u32Crc)
+{
+    static UPDATER_params Local_stParams;
+    uint32 Local_u32Base = (uint32)&Load$$ER_UPDATER$$Base;
+    // Updater_vRun at the same offset in the copy, +1 for Thumb mode
+    UPDATER_entry Local_fpUpdater = (UPDATER_entry)(RAM_APPLET_START_ADDRESS + (((uint32)&Updater_vRun & ~1uL) - Local_u32Base) + 1u);
+
+    Local_stParams.Flash = FLASH;
+    Local_stParams.Crc = CRC;
+    Local_stParams.ResetRegister = &SCB->AIRCR;
+    Local_stParams.ResetRequest = (0x5FAuL << SCB_AIRCR_VECTKEY_Pos) | (SCB->AIRCR & SCB_AIRCR_PRIGROUP_Msk) | SCB_AIRCR_SYSRESETREQ_Msk;
+    Local_stParams.WatchdogKey = &IWDG->KR;
+    Local_stParams.WatchdogRefresh = IWDG_KEY_RELOAD;
+    Local_stParams.Source = (const uint16_t*)BOOTLOADER_STAGING_ADDRESS;
+    Local_stParams.Destination = (volatile uint16_t*)FLASH_BASE_ADDRESS;
+    Local_stParams.Length = Copy_u32Length;
+    Local_stParams.PageSize = PAGE_SIZE;
+    Local_stParams.ExpectedCrc = Copy_u32Crc;
+
+    // ER_UPDATER holds the updater code and its literal pool, its length is checked at link time
+    memcpy((void*)RAM_APPLET_START_ADDRESS, (const void*)Local_u32Base, (uint32)&Image$$ER_UPDATER$$Length);
+
+    // The vector table is erased during the update, no interrupt may be taken
+    __disable_irq();
+    __DSB();
+    __ISB();
+    Local_fpUpdater(&Local_stParams);
+}
+
+#if (RAM_APPLET_STATUS == ENABLED)
+/**
+ * @brief  Copies data into the SRAM applet area.
+ *         The whole range must lie inside the applet area so the bootloader data and stack are never overwritten.
+ * @param  Host_Buffer: Pointer to the data to be copied.
+ * @param  Copy_u8Length: The length of the data in bytes.
+ * @param  Copy_u32StartAddress: The SRAM address where the data will be copied.
+ * @retval RAM_write_status: SUCCESSFUL_RAM_WRITE if the data was copied, otherwise UNSUCCESSFUL_RAM_WRITE.
+ */
+static RAM_write_status WriteRam(uint8* Host_Buffer, uint8 Copy_u8Length, uint32 Copy_u32StartAddress)
+{
+    RAM_write_status Local_enStatus = SUCCESSFUL_RAM_WRITE;
+
+    if ((Copy_u32StartAddress >= RAM_APPLET_START_ADDRESS) &&
+        ((Copy_u32StartAddress + Copy_u8Length) <= (RAM_APPLET_END_ADDRESS + 1)))
+    {
+        memcpy((void*)Copy_u32StartAddress, Host_Buffer, Copy_u8Length);
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_SUCCESSFUL_RAM_WRITE, 0);
+        #endif
+    }
+    else
+    {
+        Local_enStatus = UNSUCCESSFUL_RAM_WRITE;
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_INVALID_RAM_ADDRESS, Copy_u32StartAddress);
+        #endif
+    }
+
+    return Local_enStatus;
+}
+#endif
+
+/**
+ * @brief  Sends raw bytes to the host on the link the current frame arrived on.
+ * @param  Data: Pointer to the bytes to send.
+ * @param  Length: Number of bytes to send.
+ * @retval None
+ */
+static void SendData(const uint8 *Data, uint16 Length)
+{
+    BL_TRACE_START(TRACE_PHASE_REPLY);
+    Global_pstActiveTransport->SendFrame(Data, Length);
+    BL_TRACE_STOP(TRACE_PHASE_REPLY);
+}
+
+#if (RAM_APPLET_STATUS == ENABLED)
+/**
+ * @brief  Applet service: sends bytes to the host as framed replies, like the reply of a command.
+ *         Each reply carries at most 255 bytes, longer data is split over several replies.
+ * @param  Data: Pointer to the bytes to send.
+ * @param  Length: Number of bytes to send.
+ * @retval None
+ */
+static void Applet_SendData(const uint8 *Data, uint16 Length)
+{
+    uint8 Local_u8Chunk = 0;
+
+    while (Length > 0u)
+    {
+        Local_u8Chunk = (Length > 255u) ? (uint8)255u : (uint8)Length;
+        SendReply(Data, Local_u8Chunk);
+        Data += Local_u8Chunk;
+        Length -= Local_u8Chunk;
+    }
+}
+
+/**
+ * @brief  Applet service: programs flash, applets run outside the command table so the flash is unlocked here.
+ *         Applets come from the host and get the same application region limit as a memory write.
+ * @param  Data: Pointer to the data to be written.
+ * @param  Length: The length of the data in bytes.
+ * @param  Address: The flash address where the data will be written.
+ * @retval FLASH_write_status: Result of WriteFlash, WRITE_PAGE_RESERVED outside the application region.
+ */
+static FLASH_write_status Applet_WriteFlash(uint8 *Data, uint8 Length, uint32 Address)
+{
+    FLASH_write_status Local_enStatus = WRITE_PAGE_RESERVED;
+
+    if (!Flash_u8IsReserved(Address, Length))
+    {
+        HAL_FLASH_Unlock();
+        Local_enStatus = WriteFlash(Data, Length, Address);
+        HAL_FLASH_Lock();
+    }
+
+    return Local_enStatus;
+}
+#endif
+
+/**
+ * @brief  Feeds bytes into the CRC unit without reading or resetting it, so CalculateCrc can continue
+ *         a CRC over data that is not contiguous.
+ * @param  Data: Pointer to the bytes.
+ * @param  Length: Number of bytes.
+ * @retval None
+ */
+static void FeedCrc(const uint8 *Data, uint32 Length)
+{
+    CRC_TypeDef* Local_pstCrc = (CRC_ENGINE)->Instance;
+    uint32 Local_u32Counter = 0;
+
+    for (Local_u32Counter = 0; Local_u32Counter < Length; Local_u32Counter++)
+    {
+        LL_CRC_FeedData32(Local_pstCrc, (uint32)Data[Local_u32Counter]);
+    }
+}
+
+/**
+ * @brief  Computes the protocol CRC (one byte per CRC word) over a buffer, also the applet CalculateCrc service.
+ * @param  Data: Pointer to the bytes to checksum.
+ * @param  Length: Number of bytes.
+ * @retval uint32: The CRC value, the engine is reset afterwards.
+ */
+static uint32 CalculateCrc(const uint8 *Data, uint32 Length)
+{
+    CRC_TypeDef* Local_pstCrc = (CRC_ENGINE)->Instance;
+    uint32 Local_u32Crc = 0;
+
+    FeedCrc(Data, Length);
+    Local_u32Crc = LL_CRC_ReadData32(Local_pstCrc);
+    LL_CRC_ResetCRCCalculationUnit(Local_pstCrc);
+
+    return Local_u32Crc;
+}
+
+/**
+ * @brief  Streams data written to the application region into the running image hash.
+ *         A write at FLASH_SECTOR2_BASE_ADDRESS starts a new image, a write that continues the
+ *         previous one extends the hash, anything else breaks the stream and VerifyImage falls
+ *         back to hashing the flash contents.
+ * @param  Data: Pointer to the data that was written.
+ * @param  Copy_u8Length: The length of the data in bytes.
+ * @param  Copy_u32Address: The flash address the data was written to.
+ * @retval None
+ */
+static void Image_vTrackWrite(const uint8* Data, uint8 Copy_u8Length, uint32 Copy_u32Address)
+{
+    if (Copy_u32Address == FLASH_SECTOR2_BASE_ADDRESS)
+    {
+        SHA256_vInit(&Global_stImageHash);
+        Global_u32HashedEndAddress = FLASH_SECTOR2_BASE_ADDRESS;
+    }
+
+    if ((Global_u32HashedEndAddress != 0) && (Copy_u32Address == Global_u32HashedEndAddress))
+    {
+        SHA256_vUpdate(&Global_stImageHash, Data, Copy_u8Length);
+        Global_u32HashedEndAddress += Copy_u8Length;
+    }
+    else
+    {
+        Global_u32HashedEndAddress = 0;
+    }
+}
+
+/**
+ * @brief  Checks the signature of the application image and stores the image record on success.
+ *         When the image was received in order, the digest is already available from the streamed
+ *         hash and only the signature check remains after the last frame.
+ * @param  Copy_u32ImageLength: Length of the image in bytes, starting at FLASH_SECTOR2_BASE_ADDRESS.
+ * @param  Copy_pu8Signature: The 64-byte Ed25519 signature over the SHA-256 digest of the image.
+ * @retval IMAGE_verify_status: Result of the verification.
+ */
+static IMAGE_verify_status VerifyImage(uint32 Copy_u32ImageLength, const uint8* Copy_pu8Signature)
+{
+    IMAGE_verify_status Local_enStatus = IMAGE_SIGNATURE_INVALID;
+    IMAGE_info Local_stRecord;
+
+    // Step 1: Validate the image length against the application region
+    if ((Copy_u32ImageLength == 0) ||
+        (Copy_u32ImageLength > (APPLICATION_END_ADDRESS - FLASH_SECTOR2_BASE_ADDRESS + 1U)))
+    {
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_INVALID_IMAGE_LENGTH, Copy_u32ImageLength);
+        #endif
+        return INVALID_IMAGE_LENGTH;
+    }
+
+    // Step 2: Use the streamed digest if it covers exactly the image, otherwise hash the flash contents
+    if (Global_u32HashedEndAddress != (FLASH_SECTOR2_BASE_ADDRESS + Copy_u32ImageLength))
+    {
+        SHA256_vInit(&Global_stImageHash);
+        SHA256_vUpdate(&Global_stImageHash, (const uint8*)FLASH_SECTOR2_BASE_ADDRESS, Copy_u32ImageLength);
+    }
+    SHA256_vFinal(&Global_stImageHash, Local_stRecord.Digest);
+    Global_u32HashedEndAddress = 0;
+
+    // Step 3: Check the signature over the digest, the longest computation of the bootloader
+    BL_WATCHDOG_REFRESH();
+    if (SIGNATURE_VALID == ED25519_enVerify(Copy_pu8Signature, Local_stRecord.Digest, SHA256_DIGEST_SIZE, Global_u8arrSigningKey))
+    {
+        // Step 4: The signed image carries its version, refuse images older than the counter
+        uint16 Local_u16ImageVersion = *((volatile uint16*)(FLASH_SECTOR2_BASE_ADDRESS + IMAGE_VERSION_OFFSET));
+        uint16 Local_u16CounterVersion = ReadVersionCounter();
+
+        if ((Copy_u32ImageLength < (IMAGE_VERSION_OFFSET + 2U)) || (Local_u16ImageVersion == VERSION_ERASED_VALUE) ||
+            (Local_u16ImageVersion < Local_u16CounterVersion))
+        {
+            Local_enStatus = IMAGE_VERSION_ROLLBACK;
+            #if (DEBUG_STATUS == ENABLED)
+            Log_vWrite(LOG_IMAGE_VERSION_ROLLBACK, Local_u16ImageVersion);
+            #endif
+        }
+        // Step 5: Advance the counter first, then store the image record so the image is accepted at boot.
+        //         A record is never left behind for an image whose version the counter did not reach, a
+        //         failure after the counter write only leaves the image unbooted until it is verified again
+        else
+        {
+            Local_stRecord.Magic = IMAGE_INFO_MAGIC;
+            Local_stRecord.Length = Copy_u32ImageLength;
+            memcpy(Local_stRecord.Signature, Copy_pu8Signature, ED25519_SIGNATURE_SIZE);
+            if (((Local_u16ImageVersion == Local_u16CounterVersion) || (SUCCESSFUL_WRITE == WriteVersionCounter(Local_u16ImageVersion))) &&
+                (SUCCESSFUL_ERASE == EraseFlashPages(IMAGE_INFO_PAGE_ADDRESS, 1)) &&
+                (SUCCESSFUL_WRITE == WriteFlash((uint8*)&Local_stRecord, sizeof(Local_stRecord), IMAGE_INFO_PAGE_ADDRESS)))
+            {
+                Local_enStatus = IMAGE_SIGNATURE_VALID;
+                #if (DEBUG_STATUS == ENABLED)
+                Log_vWrite(LOG_IMAGE_SIGNATURE_VALID, 0);
+                #endif
+            }
+            else
+            {
+                Local_enStatus = IMAGE_RECORD_WRITE_FAILED;
+                #if (DEBUG_STATUS == ENABLED)
+                Log_vWrite(LOG_IMAGE_RECORD_WRITE_FAILED, 0);
+                #endif
+            }
+        }
+    }
+    else
+    {
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_IMAGE_SIGNATURE_INVALID, 0);
+        #endif
+    }
+
+    return Local_enStatus;
+}
+
+/**
+ * @brief  Checks that a verified image record exists and that the image in flash still matches it.
+ *         The SHA-256 of the image is recomputed and the stored signature is checked against it again,
+ *         so a record that did not come from VerifyImage() starts nothing.
+ *         Images older than the anti-rollback version counter are refused.
+ * @retval uint8: 1 if the image may be started, otherwise 0.
+ */
+static uint8 Image_u8IsBootable(void)
+{
+    const IMAGE_info* Local_pstRecord = (const IMAGE_info*)IMAGE_INFO_PAGE_ADDRESS;
+    SHA256_context Local_stHash;
+    uint8 Local_u8arrDigest[SHA256_DIGEST_SIZE];
+
+    if ((Local_pstRecord->Magic != IMAGE_INFO_MAGIC) || (Local_pstRecord->Length == 0) ||
+        (Local_pstRecord->Length > (APPLICATION_END_ADDRESS - FLASH_SECTOR2_BASE_ADDRESS + 1U)))
+    {
+        return 0;
+    }
+
+    // An image older than the version counter is never started, even with a valid record
+    if (*((volatile uint16*)(FLASH_SECTOR2_BASE_ADDRESS + IMAGE_VERSION_OFFSET)) < ReadVersionCounter())
+    {
+        return 0;
+    }
+
+    SHA256_vInit(&Local_stHash);
+    SHA256_vUpdate(&Local_stHash, (const uint8*)FLASH_SECTOR2_BASE_ADDRESS, Local_pstRecord->Length);
+    SHA256_vFinal(&Local_stHash, Local_u8arrDigest);
+
+    if (memcmp(Local_u8arrDigest, Local_pstRecord->Digest, SHA256_DIGEST_SIZE) != 0)
+    {
+        return 0;
+    }
+
+    BL_WATCHDOG_REFRESH();
+    return (uint8)(SIGNATURE_VALID == ED25519_enVerify(Local_pstRecord->Signature, Local_u8arrDigest, SHA256_DIGEST_SIZE, Global_u8arrSigningKey));
+}
+
+/**
+ * @brief  Changes the transfer mode used by the memory write command.
+ * @param  Copy_u8Mode: ENCRYPTION_OFF or ENCRYPTION_AES128_CTR.
+ * @param  Copy_pu8InitialCounter: The 16-byte counter block for the first byte of the application region.
+ * @retval ENCRYPTION_status: ENCRYPTION_MODE_SET if the mode is supported, otherwise ENCRYPTION_MODE_INVALID.
+ */
+static ENCRYPTION_status SetEncryptionMode(uint8 Copy_u8Mode, const uint8* Copy_pu8InitialCounter)
+{
+    ENCRYPTION_status Local_enStatus = ENCRYPTION_MODE_SET;
+
+    if (Copy_u8Mode == ENCRYPTION_AES128_CTR)
+    {
+        AES128_vInit(&Global_stAesContext, Global_u8arrDecryptionKey);
+        memcpy(Global_u8arrInitialCounter, Copy_pu8InitialCounter, AES128_BLOCK_SIZE);
+        Global_u8EncryptionMode = ENCRYPTION_AES128_CTR;
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_ENCRYPTION_AES128_CTR, 0);
+        #endif
+    }
+    else if (Copy_u8Mode == ENCRYPTION_OFF)
+    {
+        Global_u8EncryptionMode = ENCRYPTION_OFF;
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_ENCRYPTION_OFF, 0);
+        #endif
+    }
+    else
+    {
+        Local_enStatus = ENCRYPTION_MODE_INVALID;
+        #if (DEBUG_STATUS == ENABLED)
+        Log_vWrite(LOG_ENCRYPTION_MODE_INVALID, Copy_u8Mode);
+        #endif
+    }
 
-    // Check if a mass erase is requested
-    if (Copy_u32PageAddress == CBL_FLASH_MASS_ERASE) {
-        FLASH_EraseInitTypeDef Local_stFlashConfig;
-        Local_stFlashConfig.TypeErase = FLASH_TYPEERASE_MASSERASE; // Set erase type to mass erase
-        Local_stFlashConfig.Banks = FLASH_BANK_1;                  // Select flash bank to erase
-        Local_enFlashstatus=HAL_FLASH_Unlock();                                         // Unlock flash memory for writing
-        Local_enFlashstatus = HAL_FLASHEx_Erase(&Local_stFlashConfig, (uint32_t*)&Local_u32FaultyPageAddress); // Perform mass erase
-        Local_enFlashstatus=HAL_FLASH_Lock();                                          // Lock flash memory after operation
+    return Local_enStatus;
+}
 
-        // Check if the mass erase was successful
-        if ((Local_enFlashstatus == HAL_OK) && (Local_u32FaultyPageAddress == 0xFFFFFFFF)) {
-            Local_enStatus = SUCCESSFUL_ERASE; // Mass erase successful
-            #if (DEBUG_STATUS == ENABLED)
-            PrintMessage("SUCCESSFUL_MASS_ERASE"); // Print debug message for successful erase
-            #endif
-        } else {
-            Local_enStatus = UNSUCCESSFUL_ERASE; // Mass erase failed
+/**
+ * @brief  Decrypts memory write data in place when encrypted transfers are enabled.
+ *         The keystream position is the offset of the data from FLASH_SECTOR2_BASE_ADDRESS, so a
+ *         resent or reordered frame decrypts correctly without any per-transfer state.
+ * @param  Data: Pointer to the data in the receive buffer.
+ * @param  Copy_u8Length: The length of the data in bytes.
+ * @param  Copy_u32Address: The flash address the data is destined for.
+ * @retval FLASH_write_status: UNSUCCESSFUL_WRITE if encrypted data targets an address below the
+ *         application region, otherwise SUCCESSFUL_WRITE.
+ */
+static FLASH_write_status DecryptFrame(uint8* Data, uint8 Copy_u8Length, uint32 Copy_u32Address)
+{
+    FLASH_write_status Local_enStatus = SUCCESSFUL_WRITE;
+
+    if (Global_u8EncryptionMode == ENCRYPTION_AES128_CTR)
+    {
+        if (Copy_u32Address >= FLASH_SECTOR2_BASE_ADDRESS)
+        {
+            AES128_vCtrCrypt(&Global_stAesContext, Global_u8arrInitialCounter,
+                             Copy_u32Address - FLASH_SECTOR2_BASE_ADDRESS, Data, Copy_u8Length);
+        }
+        else
+        {
+            Local_enStatus = UNSUCCESSFUL_WRITE;
             #if (DEBUG_STATUS == ENABLED)
-            PrintMessage("UNSUCCESSFUL_MASS_ERASE"); // Print debug message for unsuccessful erase
+            Log_vWrite(LOG_INVALID_ENCRYPTED_ADDRESS, Copy_u32Address);
             #endif
         }
     }
-    // Check if the passed address is valid for page erase
-    else if ((Copy_u32PageAddress >= FLASH_BASE_ADDRESS) && (Copy_u32PageAddress <= FLASH_LAST_ADDRESS) && (Copy_u32PageAddress % PAGE_SIZE == 0)) {
-        // Check if the requested number of pages does not exceed the flash memory limit
-        if ((Copy_u32PageAddress + (Copy_u32NumberOfPages - 1) * PAGE_SIZE) <= FLASH_LAST_ADDRESS) {
-            FLASH_EraseInitTypeDef Local_stFlashConfig;
-            Local_stFlashConfig.TypeErase = FLASH_TYPEERASE_PAGES; // Set erase type to page erase
-            Local_stFlashConfig.NbPages = Copy_u32NumberOfPages;   // Set number of pages to erase
-            Local_stFlashConfig.PageAddress = Copy_u32PageAddress; // Set the starting page address
-            Local_enFlashstatus=HAL_FLASH_Unlock();                                      // Unlock flash memory for writing
-            Local_enFlashstatus = HAL_FLASHEx_Erase(&Local_stFlashConfig, (uint32_t*)&Local_u32FaultyPageAddress); // Perform page erase
-            Local_enFlashstatus=HAL_FLASH_Lock();                                       // Lock flash memory after operation
 
-            // Check if the page erase was successful
-            if ((Local_enFlashstatus == HAL_OK) && (Local_u32FaultyPageAddress == 0xFFFFFFFF)) {
-                Local_enStatus = SUCCESSFUL_ERASE; // Page erase successful
-                #if (DEBUG_STATUS == ENABLED)
-                PrintMessage("SUCCESSFUL_ERASE"); // Print debug message for successful erase
-                #endif
-            } else {
-                Local_enStatus = UNSUCCESSFUL_ERASE; // Page erase failed
-                #if (DEBUG_STATUS == ENABLED)
-                PrintMessage("UNSUCCESSFUL_ERASE"); // Print debug message for unsuccessful erase
-                #endif
-            }
-        } else {
-            Local_enStatus = INVALID_PAGE_NUMBER; // Requested number of pages exceeds memory limit
-            #if (DEBUG_STATUS == ENABLED)
-            PrintMessage("INVALID_PAGE_NUMBER"); // Print debug message for invalid page number
-            #endif
+    return Local_enStatus;
+}
+
+/**
+ * @brief  Finds the first erased slot of a version counter page.
+ *         Records are appended in order from the start of the page, so a binary search finds it.
+ * @param  Copy_u32PageAddress: VERSION_COUNTER_PAGE_A_ADDRESS or VERSION_COUNTER_PAGE_B_ADDRESS.
+ * @retval uint16: Index of the first erased slot, VERSION_RECORDS_PER_PAGE when the page is full.
+ */
+static uint16 FindVersionSlot(uint32 Copy_u32PageAddress)
+{
+    const volatile VERSION_record* Local_pstRecords = (const volatile VERSION_record*)Copy_u32PageAddress;
+    uint16 Local_u16Low = 0;
+    uint16 Local_u16High = VERSION_RECORDS_PER_PAGE;
+    uint16 Local_u16Middle = 0;
+
+    while (Local_u16Low < Local_u16High)
+    {
+        Local_u16Middle = (uint16)((Local_u16Low + Local_u16High) / 2u);
+        if ((Local_pstRecords[Local_u16Middle].Version == VERSION_ERASED_VALUE) &&
+            (Local_pstRecords[Local_u16Middle].Check == VERSION_ERASED_VALUE))
+        {
+            Local_u16High = Local_u16Middle;
+        }
+        else
+        {
+            Local_u16Low = Local_u16Middle + 1u;
         }
-    } else {
-        Local_enStatus = INVALID_PAGE_ADDRESS; // Invalid page address provided
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("INVALID_PAGE_ADDRESS"); // Print debug message for invalid page address
-        #endif
     }
 
-    return Local_enStatus; // Return the status of the erase operation
+    return Local_u16Low;
 }
 
 /**
- * @brief  This function writes data to flash memory in 16-bit half-word units.
- *         It handles both even and odd lengths of data, ensuring correct flash programming.
- *         The function performs boundary checks, unlocks the flash memory, writes data, 
- *         and then locks the flash again.
- * @param  Host_Buffer: Pointer to the buffer holding the data to be written to flash memory.
- * @param  Copy_u8Length: The length of the data to be written in bytes.
- * @param  Copy_u32StartAddress: The starting address in flash memory where data will be written.
- * @retval FLASH_write_status: Returns SUCCESSFUL_WRITE if successful, otherwise UNSUCCESSFUL_WRITE.
+ * @brief  Reads the newest valid record of one version counter page.
+ *         A record torn by a power loss fails its complement check and is skipped.
+ * @param  Copy_u32PageAddress: VERSION_COUNTER_PAGE_A_ADDRESS or VERSION_COUNTER_PAGE_B_ADDRESS.
+ * @retval uint16: The newest version in the page, 0 when the page holds no valid record.
  */
-static FLASH_write_status WriteFlash(uint8* Host_Buffer, uint8 Copy_u8Length, uint32 Copy_u32StartAddress)
+static uint16 ReadVersionPage(uint32 Copy_u32PageAddress)
 {
-    // Status variable to indicate if the write operation was successful or not.
-    FLASH_write_status Local_stErrState = SUCCESSFUL_WRITE;
-    // Status variable to track the result of HAL flash operations.
-    HAL_StatusTypeDef Local_enFlashstatus = HAL_OK;
+    const volatile VERSION_record* Local_pstRecords = (const volatile VERSION_record*)Copy_u32PageAddress;
+    uint16 Local_u16Slot = FindVersionSlot(Copy_u32PageAddress);
+    uint16 Local_u16Check = 0;     // Complement of a record's version, held in a uint16 so it compares without promotion
 
-    // Check if the start address is within the valid flash memory range
-    // and if the total length of data to write fits within the allowed address range.
-    if (((Copy_u32StartAddress) >= FLASH_BASE_ADDRESS) && 
-        ((Copy_u32StartAddress + Copy_u8Length) <= FLASH_LAST_ADDRESS))
+    // Walk back from the first erased slot to the newest record that passes the complement check
+    while (Local_u16Slot > 0)
     {
-        uint16 Local_u16Counter = 0;   // Counter for iterating through the buffer
-        uint16 Local_u16Data = 0;      // Temporary variable to hold 16-bit data
+        Local_u16Slot--;
+        Local_u16Check = (uint16)~Local_pstRecords[Local_u16Slot].Version;
+        if (Local_u16Check == (uint16)Local_pstRecords[Local_u16Slot].Check)
+        {
+            return Local_pstRecords[Local_u16Slot].Version;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  Reads the anti-rollback version counter.
+ *         The counter lives in two pages used in turn. Both are read and the higher value wins, so the
+ *         counter survives a power loss while the full page is being replaced.
+ * @retval uint16: The counter value, 0 when no record was written yet.
+ */
+static uint16 ReadVersionCounter(void)
+{
+    uint16 Local_u16VersionA = ReadVersionPage(VERSION_COUNTER_PAGE_A_ADDRESS);
+    uint16 Local_u16VersionB = ReadVersionPage(VERSION_COUNTER_PAGE_B_ADDRESS);
+
+    return (Local_u16VersionA >= Local_u16VersionB) ? Local_u16VersionA : Local_u16VersionB;
+}
+
+/**
+ * @brief  Appends a new version counter record using half-word programming.
+ *         Records go to the page holding the current counter. Once it is full the new value is written
+ *         as the first record of the other page, and only then is the full page erased. At no point is
+ *         the only copy of the counter erased.
+ * @param  Copy_u16Version: The new counter value.
+ * @retval FLASH_write_status: SUCCESSFUL_WRITE if the record was programmed, otherwise UNSUCCESSFUL_WRITE.
+ */
+static FLASH_write_status WriteVersionCounter(uint16 Copy_u16Version)
+{
+    VERSION_record Local_stRecord = {Copy_u16Version, (uint16)~Copy_u16Version};
+    uint32 Local_u32ActivePage = VERSION_COUNTER_PAGE_A_ADDRESS;
+    uint32 Local_u32OtherPage = VERSION_COUNTER_PAGE_B_ADDRESS;
+    uint16 Local_u16Slot = 0;
+    FLASH_write_status Local_enStatus = UNSUCCESSFUL_WRITE;
+
+    // Step 1: The page holding the current counter takes the record
+    if (ReadVersionPage(VERSION_COUNTER_PAGE_B_ADDRESS) > ReadVersionPage(VERSION_COUNTER_PAGE_A_ADDRESS))
+    {
+        Local_u32ActivePage = VERSION_COUNTER_PAGE_B_ADDRESS;
+        Local_u32OtherPage = VERSION_COUNTER_PAGE_A_ADDRESS;
+    }
+    Local_u16Slot = FindVersionSlot(Local_u32ActivePage);
+
+    if (Local_u16Slot < VERSION_RECORDS_PER_PAGE)
+    {
+        return WriteFlash((uint8*)&Local_stRecord, sizeof(Local_stRecord),
+                          Local_u32ActivePage + ((uint32)Local_u16Slot * VERSION_RECORD_SIZE));
+    }
+
+    // Step 2: The page is full, start the other page (erased first if an earlier switch left it dirty)
+    if ((0u != FindVersionSlot(Local_u32OtherPage)) && (SUCCESSFUL_ERASE != EraseFlashPages(Local_u32OtherPage, 1)))
+    {
+        return UNSUCCESSFUL_WRITE;
+    }
+    Local_enStatus = WriteFlash((uint8*)&Local_stRecord, sizeof(Local_stRecord), Local_u32OtherPage);
+
+    // Step 3: Only once the new value is in place is the full page released
+    if (SUCCESSFUL_WRITE == Local_enStatus)
+    {
+        EraseFlashPages(Local_u32ActivePage, 1);
+    }
+
+    return Local_enStatus;
+}
+
+/**
+ * @brief  Starts a new update transaction by erasing the journal page and writing its magic.
+ * @retval None
+ */
+static void Journal_vReset(void)
+{
+    uint32 Local_u32Magic = JOURNAL_MAGIC;
+
+    if (SUCCESSFUL_ERASE == EraseFlashPages(JOURNAL_PAGE_ADDRESS, 1))
+    {
+        WriteFlash((uint8*)&Local_u32Magic, sizeof(Local_u32Magic), JOURNAL_PAGE_ADDRESS);
+    }
+    Global_u32CommitEndAddress = FLASH_SECTOR2_BASE_ADDRESS;
+}
+
+/**
+ * @brief  Records erased application pages in the update journal.
+ *         Erasing the first application page starts a new transaction. Re-erasing a page that was
+ *         already committed rewrites the journal without the committed marks from that page on,
+ *         so the committed prefix never covers stale data. The journal has a single page, so a
+ *         power loss between its erase and the rewrite drops the whole transaction. This is a
+ *         deliberate conservative fallback: without the magic the prefix is empty, every page that
+ *         holds data is reported stale and the host starts over, nothing old is ever committed.
+ * @param  Copy_u32PageAddress: Address of the first erased page.
+ * @param  Copy_u32NumberOfPages: Number of erased pages.
+ * @retval None
+ */
+static void Journal_vRecordErase(uint32 Copy_u32PageAddress, uint32 Copy_u32NumberOfPages)
+{
+    uint16 Local_u16Mark = JOURNAL_MARK_SET;
+    uint32 Local_u32Counter = 0;
 
-        // Unlock the flash memory to allow writing
-        Local_enFlashstatus = HAL_FLASH_Unlock();  
+    for (Local_u32Counter = 0; Local_u32Counter < Copy_u32NumberOfPages; Local_u32Counter++)
+    {
+        uint32 Local_u32Address = Copy_u32PageAddress + (Local_u32Counter * PAGE_SIZE);
+        uint32 Local_u32Page = (Local_u32Address - FLASH_SECTOR2_BASE_ADDRESS) / PAGE_SIZE;
 
-        // Check if the flash was successfully unlocked and if the data length is odd
-        if ((HAL_OK == Local_enFlashstatus) && (Copy_u8Length % 2 != 0))
+        // Only application pages are journaled
+        if ((Local_u32Address < FLASH_SECTOR2_BASE_ADDRESS) || (Local_u32Address > APPLICATION_END_ADDRESS))
         {
-            // Handle the last byte if the length is odd, as flash writes must be done in 16-bit chunks.
-            // Load the last byte into a 16-bit variable and mask the higher byte to preserve only the lower byte.
-            Local_u16Data = *((uint16 *)(Host_Buffer + Copy_u8Length - 1));
-            Local_u16Data = Local_u16Data & 0xFF; // Mask the upper byte (keep only lower 8 bits)
-            
-            // Write the last byte to flash memory as a 16-bit half-word (only lower byte will be valid)
-            Local_enFlashstatus = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, Copy_u32StartAddress + Copy_u8Length - 1, Local_u16Data);
-            Copy_u8Length--;  // Decrease the length by 1 to make it even
+            continue;
         }
 
-        // Loop through the buffer and write data in 16-bit chunks (two bytes at a time)
-        for (Local_u16Counter = 0; ((Local_enFlashstatus == HAL_OK) && (Local_u16Counter < Copy_u8Length)); Local_u16Counter += 2)
+        // Step 1: A new update starts at the first application page or when the journal is not initialized
+        if ((Local_u32Page == 0) || (Global_pstJournal->Magic != JOURNAL_MAGIC))
         {
-            // Read two consecutive bytes from the buffer and combine them into a 16-bit half-word
-            Local_u16Data = *((uint16 *)(Host_Buffer + Local_u16Counter));
-            
-            // Write the 16-bit half-word to the flash memory at the corresponding address
-            Local_enFlashstatus = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, Copy_u32StartAddress + Local_u16Counter, Local_u16Data);
+            Journal_vReset();
         }
+        // Step 2: Drop the committed marks from a re-erased page on
+        else if (Global_pstJournal->Pages[Local_u32Page].Committed == JOURNAL_MARK_SET)
+        {
+            JOURNAL_info Local_stJournal;
+            uint32 Local_u32LaterPage = 0;
 
-        // Lock the flash memory again after writing to prevent accidental writes
-        HAL_FLASH_Lock();
+            memcpy(&Local_stJournal, (const void*)JOURNAL_PAGE_ADDRESS, sizeof(Local_stJournal));
+            for (Local_u32LaterPage = Local_u32Page; Local_u32LaterPage < APPLICATION_PAGE_COUNT; Local_u32LaterPage++)
+            {
+                Local_stJournal.Pages[Local_u32LaterPage].Committed = 0xFFFF;
+            }
+            if (SUCCESSFUL_ERASE == EraseFlashPages(JOURNAL_PAGE_ADDRESS, 1))
+            {
+                WriteFlash((uint8*)&Local_stJournal, sizeof(Local_stJournal), JOURNAL_PAGE_ADDRESS);
+            }
+        }
 
-        // Check if the entire flash write operation was successful
-        if (HAL_OK == Local_enFlashstatus)
+        // Step 3: Set the erased mark of the page
+        if (Global_pstJournal->Pages[Local_u32Page].Erased != JOURNAL_MARK_SET)
         {
-            Local_stErrState = SUCCESSFUL_WRITE;  // Mark the operation as successful
-            #if (DEBUG_STATUS == ENABLED)
-            PrintMessage("Successful Write");  // Debug message indicating successful write
-            #endif
+            WriteFlash((uint8*)&Local_u16Mark, sizeof(Local_u16Mark), (uint32)&Global_pstJournal->Pages[Local_u32Page].Erased);
         }
-        else
+
+        // Step 4: The committed prefix cannot extend past an erased page
+        if (Global_u32CommitEndAddress > Local_u32Address)
         {
-            Local_stErrState = UNSUCCESSFUL_WRITE;  // Mark the operation as failed
-            #if (DEBUG_STATUS == ENABLED)
-            PrintMessage("Unsuccessful Write");  // Debug message indicating failure in writing
-            #endif
+            Global_u32CommitEndAddress = Local_u32Address;
         }
     }
-    else
+}
+
+/**
+ * @brief  Lets a write continue a partially written page after a reset.
+ *         BL_vInit() restores the committed prefix to the start of the first page that is not
+ *         committed. A host that resumes at the end of the programmed part of that page, as reported
+ *         by GetPageState(), moves the prefix there so its writes keep committing pages. Must be
+ *         called before the data is written.
+ * @param  Copy_u32Address: The flash address the data will be written to.
+ * @retval None
+ */
+static void Journal_vResumeWrite(uint32 Copy_u32Address)
+{
+    uint32 Local_u32PageAddress = Global_u32CommitEndAddress;
+
+    // Only a prefix that ends on a page boundary inside the application region can be resumed
+    if ((Copy_u32Address <= Local_u32PageAddress) || (Local_u32PageAddress > APPLICATION_END_ADDRESS) ||
+        (((Local_u32PageAddress - FLASH_SECTOR2_BASE_ADDRESS) % PAGE_SIZE) != 0))
     {
-        // If the start address or address range is invalid, return error status
-        Local_stErrState = UNSUCCESSFUL_WRITE;
-        #if (DEBUG_STATUS == ENABLED)
-        PrintMessage("INVALID_ADDRESS");  // Debug message indicating invalid flash address range
-        #endif
+        return;
     }
 
-    // Return the final status of the flash write operation
-    return Local_stErrState;
+    // The page must have been erased by this update and the write must start right after its programmed part
+    if ((Journal_u8IsErased((Local_u32PageAddress - FLASH_SECTOR2_BASE_ADDRESS) / PAGE_SIZE)) &&
+        (Copy_u32Address == (Local_u32PageAddress + (Journal_u32ProgrammedWords(Local_u32PageAddress) * 4u))))
+    {
+        Global_u32CommitEndAddress = Copy_u32Address;
+    }
 }
 
+/**
+ * @brief  Counts the words of a page in front of its trailing run of erased (0xFFFFFFFF) words.
+ * @param  Copy_u32PageAddress: Address of the page.
+ * @retval uint32: The number of programmed words, 0 for an erased page.
+ */
+static uint32 Journal_u32ProgrammedWords(uint32 Copy_u32PageAddress)
+{
+    const uint32* Local_pu32Page = (const uint32*)Copy_u32PageAddress;
+    uint32 Local_u32Words = PAGE_SIZE / 4u;
+
+    while ((Local_u32Words > 0) && (Local_pu32Page[Local_u32Words - 1u] == 0xFFFFFFFFU))
+    {
+        Local_u32Words--;
+    }
 
+    return Local_u32Words;
+}
 
 /**
- * @brief  Change the Read-Out Protection (ROP) level of the Flash memory.
- *         This function updates the RDP level of the flash memory to the specified value
- *         by unlocking the option bytes, modifying the RDP level, and locking the option bytes again.
- * @param  Copy_u8ROPLevel: Desired ROP level to be set (0, 1, or 2).
- * @retval FLASH_CHANGE_PROTECTION_status: ROP_LEVEL_CHANGE_VALID if the operation succeeds, 
- *         ROP_LEVEL_CHANGE_INVALID if the operation fails at any step.
+ * @brief  Checks whether an application page was erased during the current update.
+ *         Data in a page without the erased mark is left over from the previous image.
+ * @param  Copy_u32Page: Application page number.
+ * @retval uint8: 1 if the journal is initialized and the erased mark of the page is set, 0 otherwise.
  */
-static FLASH_CHANGE_PROTECTION_status ChangeROPLevel(uint8 Copy_u8ROPLevel)
+static uint8 Journal_u8IsErased(uint32 Copy_u32Page)
 {
-    // Initialize status variables for flash operation and error state
-	HAL_StatusTypeDef Local_stFlashStatus = HAL_OK;
-	FLASH_CHANGE_PROTECTION_status Local_stErrState = ROP_LEVEL_CHANGE_VALID;
+    return (uint8)((Global_pstJournal->Magic == JOURNAL_MAGIC) &&
+                   (Global_pstJournal->Pages[Copy_u32Page].Erased == JOURNAL_MARK_SET));
+}
 
-    // Unlock option bytes to allow programming of ROP level
-	Local_stFlashStatus = HAL_FLASH_OB_Unlock();
-	if (Local_stFlashStatus == HAL_OK)
-	{
-		#if (DEBUG_STATUS == ENABLED)
-		PrintMessage("Successful_OB_Unlock");  // Debug message indicating successful option byte unlock
-		#endif
+/**
+ * @brief  Extends the committed prefix of the application region after a memory write.
+ *         Writes that continue the prefix advance it, and every page that becomes completely
+ *         written gets its committed mark, so an interrupted update resumes from the next page.
+ * @param  Copy_u32Address: The flash address the data was written to.
+ * @param  Copy_u8Length: The length of the data in bytes.
+ * @retval None
+ */
+static void Journal_vRecordWrite(uint32 Copy_u32Address, uint8 Copy_u8Length)
+{
+    uint16 Local_u16Mark = JOURNAL_MARK_SET;
+    uint32 Local_u32Page = 0;
 
-        // Initialize the configuration structure for the option bytes
-		FLASH_OBProgramInitTypeDef Local_stFlashConfig;
-		Local_stFlashConfig.Banks = FLASH_BANK_1;  // Specify the flash bank
-		Local_stFlashConfig.OptionType = OPTIONBYTE_RDP;  // Specify that the RDP option is to be programmed
-		Local_stFlashConfig.RDPLevel = Copy_u8ROPLevel;  // Set the desired RDP level
+    if ((Global_pstJournal->Magic != JOURNAL_MAGIC) || (Copy_u32Address != Global_u32CommitEndAddress) ||
+        (Copy_u32Address > APPLICATION_END_ADDRESS))
+    {
+        return;
+    }
 
-        // Program the RDP level into the option bytes
-		Local_stFlashStatus = HAL_FLASHEx_OBProgram(&Local_stFlashConfig);
-		if (Local_stFlashStatus == HAL_OK)
-		{
-			#if (DEBUG_STATUS == ENABLED)
-			PrintMessage("Successful_ROP_CHANGE");  // Debug message indicating successful ROP level change
-			#endif
+    // Mark each page whose last byte has now been written
+    for (Local_u32Page = (Global_u32CommitEndAddress - FLASH_SECTOR2_BASE_ADDRESS) / PAGE_SIZE;
+         (Local_u32Page < APPLICATION_PAGE_COUNT) &&
+         ((FLASH_SECTOR2_BASE_ADDRESS + ((Local_u32Page + 1U) * PAGE_SIZE)) <= (Copy_u32Address + Copy_u8Length));
+         Local_u32Page++)
+    {
+        if (Global_pstJournal->Pages[Local_u32Page].Committed != JOURNAL_MARK_SET)
+        {
+            WriteFlash((uint8*)&Local_u16Mark, sizeof(Local_u16Mark), (uint32)&Global_pstJournal->Pages[Local_u32Page].Committed);
+        }
+    }
+    Global_u32CommitEndAddress = Copy_u32Address + Copy_u8Length;
+}
 
-            // Launch the option byte programming operation
-			HAL_FLASH_OB_Launch();
+/**
+ * @brief  Builds the page state reply for the application region.
+ *         Each page is scanned backwards for its trailing run of erased (0xFFFFFFFF) words and
+ *         checksummed with the hardware CRC unit. Pages before the resume offset are committed in
+ *         the journal, the resume offset continues after the programmed part of the first page that
+ *         is not. A page holding data the current update has not erased is stale, the resume offset
+ *         then starts at the page so the host erases it first. The scan only reads flash, Journal_vResumeWrite() picks the offset up on the write.
+ * @param  Copy_pu8Reply: Output buffer of PAGE_STATE_REPLY_SIZE bytes.
+ * @retval uint16: The reply length in bytes.
+ */
+static uint16 GetPageState(uint8* Copy_pu8Reply)
+{
+    CRC_TypeDef* Local_pstCrc = (CRC_ENGINE)->Instance;
+    uint16 Local_u16ReplySize = 4u;
+    uint32 Local_u32ResumeOffset = 0;
+    uint8 Local_u8ResumeFound = 0;
+    uint32 Local_u32Page = 0;
 
-            // Lock the option bytes after the ROP level is changed
-			Local_stFlashStatus = HAL_FLASH_OB_Lock();
-			if (Local_stFlashStatus == HAL_OK)
-			{
-				#if (DEBUG_STATUS == ENABLED)
-				PrintMessage("Successful_OB_Lock");  // Debug message indicating successful option byte lock
-				#endif
-			}
-			else
-			{
-				#if (DEBUG_STATUS == ENABLED)
-				PrintMessage("Unsuccessful_OB_Lock");  // Debug message indicating failure in locking option bytes
-				#endif
-				Local_stErrState = ROP_LEVEL_CHANGE_INVALID;  // Error state if locking fails
-			}
-		}
-		else
-		{
-            // If ROP level programming fails, return error and lock option bytes
-			Local_stErrState = ROP_LEVEL_CHANGE_INVALID;
-			HAL_FLASH_OB_Lock();
-			#if (DEBUG_STATUS == ENABLED)
-			PrintMessage("UnSuccessful_ROP_CHANGE");  // Debug message indicating successful ROP level change
-			#endif
-		}
-	}
-	else
-	{
-		#if (DEBUG_STATUS == ENABLED)
-		PrintMessage("Unsuccessful_OB_Unlock");  // Debug message indicating failure in unlocking option bytes
-		#endif
-        // Error state if unlocking option bytes fails
-		Local_stErrState = ROP_LEVEL_CHANGE_INVALID;
-		HAL_FLASH_OB_Lock();  // Ensure option bytes are locked even if unlock fails
-	}
+    for (Local_u32Page = 0; Local_u32Page < APPLICATION_PAGE_COUNT; Local_u32Page++)
+    {
+        uint32 Local_u32PageAddress = FLASH_SECTOR2_BASE_ADDRESS + (Local_u32Page * PAGE_SIZE);
+        const uint32* Local_pu32Page = (const uint32*)Local_u32PageAddress;
+        uint8* Local_pu8Entry = Copy_pu8Reply + Local_u16ReplySize;
+        uint32 Local_u32ProgrammedWords = 0;
+        uint32 Local_u32Crc = 0;
+        uint32 Local_u32Word = 0;
+        uint8 Local_u8State = PAGE_STATE_ERASED;
+
+        // Step 1: Find the end of the programmed part of the page
+        Local_u32ProgrammedWords = Journal_u32ProgrammedWords(Local_u32PageAddress);
+
+        // Step 2: Classify the page
+        if ((Global_pstJournal->Magic == JOURNAL_MAGIC) && (Global_pstJournal->Pages[Local_u32Page].Committed == JOURNAL_MARK_SET))
+        {
+            Local_u8State = PAGE_STATE_COMPLETE;
+        }
+        else if (Local_u32ProgrammedWords > 0)
+        {
+            Local_u8State = Journal_u8IsErased(Local_u32Page) ? PAGE_STATE_PARTIAL : PAGE_STATE_STALE;
+        }
 
-	return Local_stErrState;  // Return the final error state of the operation
+        // Step 3: The first page that is not complete determines where the host resumes
+        if ((!Local_u8ResumeFound) && (Local_u8State != PAGE_STATE_COMPLETE))
+        {
+            Local_u32ResumeOffset = Local_u32Page * PAGE_SIZE;
+            if (Local_u8State == PAGE_STATE_PARTIAL)
+            {
+                Local_u32ResumeOffset += Local_u32ProgrammedWords * 4u;
+            }
+            Local_u8ResumeFound = 1;
+        }
+
+        // Step 4: Checksum the whole page with the hardware CRC unit
+        LL_CRC_ResetCRCCalculationUnit(Local_pstCrc);
+        for (Local_u32Word = 0; Local_u32Word < (PAGE_SIZE / 4u); Local_u32Word++)
+        {
+            LL_CRC_FeedData32(Local_pstCrc, Local_pu32Page[Local_u32Word]);
+        }
+        Local_u32Crc = LL_CRC_ReadData32(Local_pstCrc);
+
+        Local_pu8Entry[0] = Local_u8State;
+        memcpy(Local_pu8Entry + 1, &Local_u32Crc, 4);
+        Local_u16ReplySize += PAGE_STATE_ENTRY_SIZE;
+    }
+    LL_CRC_ResetCRCCalculationUnit(Local_pstCrc);
+
+    if (!Local_u8ResumeFound)
+    {
+        Local_u32ResumeOffset = APPLICATION_PAGE_COUNT * PAGE_SIZE;
+    }
+    memcpy(Copy_pu8Reply, &Local_u32ResumeOffset, 4);
+
+    return Local_u16ReplySize;
 }
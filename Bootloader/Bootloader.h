@@ -3,19 +3,26 @@
 
 /********************************************Library Include Start********************************************/
 // Standard Libraries
-#include <stdio.h>
 #include "STD_TYPES.h"   // Standard type definitions
 #include <string.h>      // String manipulation functions
-#include <stdarg.h>      // Variable argument list handling
-#include "usart.h"       // USART communication functions
 #include "crc.h"         // CRC calculation functions
+#include "stm32f1xx_ll_crc.h"   // Register-level CRC unit access on the data path
+#include "Sha256.h"      // Streaming SHA-256 of the received image
+#include "Ed25519.h"     // Image signature verification
+#include "Aes128.h"      // Decryption of encrypted transfers
+#include "Fec.h"         // Reed-Solomon correction of host frames
+#include "Updater.h"     // SRAM-resident bootloader updater
+#include "Log.h"         // Deferred debug logging
+#include "Trace.h"       // DWT cycle timing of the command phases
+#include "Transport.h"   // Transport backend interface
+#include "UartLink.h"    // USART3 polling and DMA transports
+#include "UsbLink.h"     // USB full-speed bulk transport
+#include "CanLink.h"     // ISO-TP transport on bxCAN
+#include "SpiLink.h"     // SPI slave transport with a READY handshake
+#include "ImageKeys.h"   // Keys of the signing authority, kept out of the repository
 /********************************************Library Include End********************************************/
 
 /**************************************Bootloader Macros Declaration Start**************************************/
-// Define ports for debugging and communication
-#define DEBUGING_PORT                          &huart2      // Debugging port
-#define COMMUNICATION_PORT                     &huart3      // Communication port for bootloader commands
-
 // Define CRC engine for data integrity checks
 #define CRC_ENGINE                             &hcrc        // CRC handler
 
@@ -25,18 +32,83 @@
 
 // Debugging settings
 #define UART_DEBUG                             1u          // UART debugging enabled
-#define BUFFER_SIZE                             200u        // Buffer size for data transmission
-
-// Flash memory base addresses
-#define FLASH_SECTOR2_BASE_ADDRESS             0x08008000U // Base address for sector 2 of Flash memory
 
 // Status definitions
 #define ENABLED                                 1u          // Enabled state
 #define DISABLED                                2u          // Disabled state
 
+// Size-optimized build, define BL_SIZE_OPTIMIZED=1 in the Keil target (C/C++ Define) together with -Oz
+#ifndef BL_SIZE_OPTIMIZED
+#define BL_SIZE_OPTIMIZED                       DISABLED     // Full build with debug output, phase timing and FEC
+#endif
+
+// Bootloader region size, the same for both builds, BOOTLOADER_REGION_SIZE in Bootloader.sct fails the link beyond it
+#define BOOTLOADER_REGION_SIZE                 0x00008000U  // 32 KB, application linked at 0x08008000
+
+// Flash memory base addresses
+#define FLASH_SECTOR2_BASE_ADDRESS             (0x08000000U + BOOTLOADER_REGION_SIZE) // Base address of the application (vector table)
+
 // Debugging method settings
 #define DEBUG_METHODE                          UART_DEBUG   // Method for debugging
+#if (BL_SIZE_OPTIMIZED == ENABLED)
+#define DEBUG_STATUS                            DISABLED     // No debug logging in the size-optimized build
+#else
 #define DEBUG_STATUS                            ENABLED      // Debugging status
+#endif
+
+// Phase timing settings, CBL_GET_TRACE_CMD reports the per-command histograms
+#if (BL_SIZE_OPTIMIZED == ENABLED)
+#define TRACE_STATUS                            DISABLED     // No phase timing in the size-optimized build
+#else
+#define TRACE_STATUS                            ENABLED      // Time receive, CRC, erase, program and reply with the DWT cycle counter
+#endif
+
+// Forward error correction settings, CBL_SET_FEC_CMD selects the parity size of the frames
+#if (BL_SIZE_OPTIMIZED == ENABLED)
+#define FEC_STATUS                              DISABLED     // No Reed-Solomon decoder in the size-optimized build
+#else
+#define FEC_STATUS                              ENABLED      // Correct byte errors of host frames before the CRC check
+#endif
+
+// CAN link settings, USB and bxCAN share the packet SRAM of the F103 so only one of them can run
+#ifndef CAN_LINK_STATUS
+#define CAN_LINK_STATUS                         DISABLED     // ENABLED replaces the USB link with the CAN link
+#endif
+
+// RS-485 settings, several nodes share USART3 and only the addressed one wakes up (node address in UartLink.h)
+#ifndef RS485_LINK_STATUS
+#define RS485_LINK_STATUS                       DISABLED     // ENABLED runs USART3 in multiprocessor mute mode
+#endif
+
+// SPI link settings, SPI2 slave on PB12..PB15 with the READY handshake on PB1
+#ifndef SPI_LINK_STATUS
+#define SPI_LINK_STATUS                         DISABLED     // ENABLED adds the SPI link to the polled transports
+#endif
+
+// Watchdog settings, once started the IWDG cannot be stopped and the application must keep refreshing it
+#ifndef WATCHDOG_STATUS
+#define WATCHDOG_STATUS                         DISABLED     // ENABLED starts the IWDG in BL_vInit (required with the hardware watchdog option)
+#endif
+#define WATCHDOG_PRESCALER                     IWDG_PRESCALER_64 // 40 kHz LSI / 64 = 625 Hz
+#define WATCHDOG_RELOAD                        2500u        // 4 s nominal, 2.6 s at the fastest LSI (60 kHz)
+
+// Idle settings, the command loop sleeps with WFI between frames
+#define IDLE_TIMEOUT                           30000u       // ms without a frame before the application is started, 0 waits forever
+#define FRAME_TIMEOUT                          500u         // ms from the first byte until a frame must be complete, then it is dropped
+#ifndef IDLE_CLOCK_STATUS
+#if (CAN_LINK_STATUS == ENABLED) || (SPI_LINK_STATUS == ENABLED)
+#define IDLE_CLOCK_STATUS                       DISABLED     // CAN bit timing and the SPI slave need the full APB1 clock
+#else
+#define IDLE_CLOCK_STATUS                       ENABLED      // Run from HSI 8 MHz until the first valid frame arrives
+#endif
+#endif
+
+// UART transport for bootloader commands, UART_PORT in UartLink.h (the debug port is LOG_PORT in Log.h)
+#if (RS485_LINK_STATUS == ENABLED)
+#define UART_TRANSPORT                         UartLink_stRs485 // Addressed frames, replies drive the transceiver enable
+#else
+#define UART_TRANSPORT                         UartLink_stDma // UartLink_stPolling sends replies by polling TXE
+#endif
 
 // Flash Memory Address Range
 #define FLASH_START_ADDRESS                    0x08000000U  // Start address of Flash memory
@@ -46,6 +118,10 @@
 #define SRAM_START_ADDRESS                     0x20000000U  // Start address of SRAM
 #define SRAM_END_ADDRESS                       0x20004FFFU  // End address of SRAM
 
+// RAM Applet Staging Area (upper SRAM, the scatter file MDK-ARM/Bootloader.sct links the bootloader data and stack below it)
+#define RAM_APPLET_START_ADDRESS               0x20002000U  // Start address of the applet area, RAM_APPLET_START in Bootloader.sct
+#define RAM_APPLET_END_ADDRESS                 SRAM_END_ADDRESS // End address of the applet area
+
 // Address validity checks
 #define ADDRESS_IS_INVALID                     0x00         // Address is invalid
 #define ADDRESS_IS_VALID                       0x01         // Address is valid
@@ -58,7 +134,31 @@
 #define CBL_GO_TO_ADDR_CMD                     0x14         // Command to jump to a specified address
 #define CBL_FLASH_ERASE_CMD                    0x15         // Command to erase flash memory
 #define CBL_MEM_WRITE_CMD                      0x16         // Command to write to memory
+#define CBL_RAM_WRITE_CMD                      0x17         // Command to write an applet into SRAM
+#define CBL_VERIFY_IMAGE_CMD                   0x18         // Command to verify the signature of the application image
+#define CBL_SET_ENCRYPTION_CMD                 0x19         // Command to select plaintext or encrypted memory writes
+#define CBL_GET_PAGE_STATE_CMD                 0x1A         // Command to get the resume offset and per-page state of the application
+#define CBL_BATCH_CMD                          0x1B         // Command to run a sequence of erase/write/CRC check/jump operations
+#define CBL_WRITE_OPTION_BYTES_CMD             0x1C         // Command to program RDP, USER, DATA0/1 and WRP in one cycle
+#define CBL_PROTECT_BOOTLOADER_CMD             0x1D         // Command to write-protect every bootloader page
+#define CBL_UNPROTECT_BOOTLOADER_CMD           0x1E         // Command to remove the write protection of the bootloader pages
+#define CBL_UPDATE_BOOTLOADER_CMD              0x1F         // Command to replace the bootloader with the image staged in the application region
+#define CBL_GET_TRACE_CMD                      0x20         // Command to read the phase timing histograms of a command
 #define CBL_CHANGE_ROP_Level_CMD               0x21         // Command to change Read Out Protection Level
+#define CBL_BROADCAST_WRITE_CMD                0x22         // Command to write a numbered block of a broadcast update
+#define CBL_GET_GAP_REPORT_CMD                 0x23         // Command to list the broadcast blocks this node is missing
+#define CBL_GET_LINK_STATS_CMD                 0x24         // Command to read the frame error counters of the link
+#define CBL_SET_FEC_CMD                        0x25         // Command to select the Reed-Solomon parity size of host frames
+
+// Command Table Settings
+#define CBL_FIRST_CMD                          CBL_GET_VER_CMD           // Lowest command code, first table entry
+#define CBL_LAST_CMD                           CBL_SET_FEC_CMD           // Highest command code, last table entry
+#define CBL_COMMAND_TABLE_SIZE                 (CBL_LAST_CMD - CBL_FIRST_CMD + 1) // Entries indexed by command - CBL_FIRST_CMD
+#define CBL_FLAG_NONE                          0x00u        // Plain command
+#define CBL_FLAG_NEEDS_UNLOCK                  0x01u        // Handler programs flash or option bytes, runs with the flash unlocked
+#define CBL_MIN_LENGTH(FRAME)                  (sizeof(FRAME) - 1u + CRC_SIZE) // Smallest length byte of a frame with descriptor FRAME
+#define CBL_MEM_WRITE_MIN_LENGTH               CBL_MIN_LENGTH(CBL_mem_write_frame) // Length byte of a memory write frame without data
+#define CBL_BROADCAST_WRITE_MIN_LENGTH         CBL_MIN_LENGTH(CBL_broadcast_write_frame) // Length byte of a broadcast write frame without data
 
 #define IDCODE_MASK                            0xFFF        // Mask for ID code
 
@@ -77,6 +177,108 @@
 #define PAGE_SIZE                              0x00000400   // Size of a single page (1 KB or 1024 bytes)
 
 #define CBL_FLASH_MASS_ERASE                   0xFF        // Command to perform a mass erase of flash
+
+// Signed Image Settings
+#ifndef IMAGE_SIGNATURE_CHECK
+#define IMAGE_SIGNATURE_CHECK                  ENABLED      // Only boot images that passed CBL_VERIFY_IMAGE_CMD
+#endif
+
+// RAM applets are unsigned native code that can program the flash and read the keys, they would bypass the signature check
+#ifndef RAM_APPLET_STATUS
+#if (IMAGE_SIGNATURE_CHECK == ENABLED)
+#define RAM_APPLET_STATUS                      DISABLED     // CBL_RAM_WRITE_CMD and applet addresses are refused
+#else
+#define RAM_APPLET_STATUS                      ENABLED      // Applets may be written and called
+#endif
+#endif
+#if (IMAGE_SIGNATURE_CHECK == ENABLED) && (RAM_APPLET_STATUS == ENABLED)
+#error "RAM applets cannot be enabled together with IMAGE_SIGNATURE_CHECK"
+#endif
+#define IMAGE_INFO_PAGE_ADDRESS                0x0800FC00U  // Last flash page, holds the verified image record
+#define IMAGE_INFO_MAGIC                       0x4E474953U  // "SIGN", marks a valid image record
+#define APPLICATION_END_ADDRESS                (VERSION_COUNTER_PAGE_B_ADDRESS - 1U) // Last byte available to the application image, the reserved pages follow
+#define APPLICATION_PAGE_COUNT                 ((APPLICATION_END_ADDRESS + 1U - FLASH_SECTOR2_BASE_ADDRESS) / PAGE_SIZE) // Pages in the application region
+
+// Update Journal Settings
+#define JOURNAL_PAGE_ADDRESS                   0x0800F400U  // Flash page holding the update transaction journal
+#define JOURNAL_MAGIC                          0x4C4E524AU  // "JRNL", marks an initialized journal
+#define JOURNAL_MARK_SET                       0x0000u      // Half-word value of a set journal mark (erased value is 0xFFFF)
+
+// Batch Command Settings
+#define BATCH_OP_ERASE                         0x01         // Erase pages (CBL_batch_erase_op)
+#define BATCH_OP_WRITE                         0x02         // Write a block to flash (CBL_batch_write_op)
+#define BATCH_OP_CRC_CHECK                     0x03         // Compare the CRC of a flash range (CBL_batch_crc_op)
+#define BATCH_OP_JUMP                          0x04         // Jump to an address after the reply (CBL_batch_jump_op), must be last
+#define BATCH_MAX_OPERATIONS                   32u          // Largest number of operations in one batch
+#define BATCH_OP_SKIPPED                       0xFE         // Result of operations after a failed one
+#define BATCH_OP_MALFORMED                     0xFF         // Result of an unknown or truncated operation
+
+// Option Bytes Settings
+#define OPTION_BYTES_COUNT                     8u           // RDP, USER, DATA0, DATA1, WRP0..WRP3
+#define OPTION_BYTE_ERASED                     0xFFu        // Value of an erased option byte, not programmed
+#define OPTION_USER_RESERVED_BITS              0xF8u        // Unused USER bits, kept erased
+
+// Write Protection Settings
+#define WRP_GROUP_SIZE                         (4u * PAGE_SIZE) // Flash covered by one WRP bit (4 pages)
+#define BOOTLOADER_WRP_GROUPS                  ((1u << ((FLASH_SECTOR2_BASE_ADDRESS - FLASH_BASE_ADDRESS) / WRP_GROUP_SIZE)) - 1u) // WRP bits of the bootloader region
+
+// Bootloader Self-Update Settings
+#define BOOTLOADER_STAGING_ADDRESS             FLASH_SECTOR2_BASE_ADDRESS // New bootloader image is written here first
+
+// Page State Reply
+#define PAGE_STATE_ENTRY_SIZE                  5u           // State byte followed by the 32-bit page CRC
+#define PAGE_STATE_REPLY_SIZE                  (4u + (APPLICATION_PAGE_COUNT * PAGE_STATE_ENTRY_SIZE)) // Resume offset and one entry per application page
+
+// Trace Reply
+#define TRACE_REPLY_SIZE                       (4u + sizeof(TRACE_command_stats)) // Core clock in Hz followed by the phase statistics
+#if (TRACE_STATUS == ENABLED)
+#define BL_TRACE_START(PHASE)                  Trace_vStart(PHASE)          // Timestamp the start of a phase
+#define BL_TRACE_STOP(PHASE)                   Trace_vStop(PHASE)           // Account the phase to the current frame
+#else
+#define BL_TRACE_START(PHASE)
+#define BL_TRACE_STOP(PHASE)
+#endif
+
+// Watchdog Refresh
+#if (WATCHDOG_STATUS == ENABLED)
+#define BL_WATCHDOG_REFRESH()                  HAL_IWDG_Refresh(&Global_stWatchdog) // One key register write
+#else
+#define BL_WATCHDOG_REFRESH()
+#endif
+
+// Broadcast Update Settings
+#define BROADCAST_MAX_BLOCKS                   1024u        // Blocks tracked per broadcast session (one bit each)
+#define GAP_REPORT_MAX_ENTRIES                 ((255u - 2u) / 2u) // Missing block numbers that fit behind the one-byte ACK size
+#define GAP_REPORT_REPLY_SIZE                  (2u + (GAP_REPORT_MAX_ENTRIES * 2u)) // Missing count and a window of block numbers
+
+// Link Statistics Reply
+#define LINK_STATS_REPLY_SIZE                  sizeof(LINK_stats) // Frame and byte counters of the link the request arrived on
+
+// Anti-Rollback Settings
+#define VERSION_COUNTER_PAGE_A_ADDRESS         0x0800F800U  // First of the two pages holding the append-only version counter records
+#define VERSION_COUNTER_PAGE_B_ADDRESS         0x0800F000U  // Second page, takes over when the first is full and the other way round
+#define VERSION_RECORD_SIZE                    4u           // Version (16 bits) followed by its complement (16 bits)
+#define VERSION_RECORDS_PER_PAGE               (PAGE_SIZE / VERSION_RECORD_SIZE) // Updates before the other page takes over
+#define VERSION_ERASED_VALUE                   0xFFFFu      // Value of an erased half-word
+#define IMAGE_VERSION_OFFSET                   0x1Cu        // Image version (16 bits) in the first reserved vector table entry
+
+// Every application page has an entry in the page state reply
+#if (PAGE_STATE_REPLY_SIZE > 255u)
+#error "The page state reply does not fit the one-byte ACK size, shrink the application region"
+#endif
+
+// Ed25519 public key of the image signing authority, defined in ImageKeys.h (see ImageKeys_template.h)
+#ifndef IMAGE_SIGNING_PUBLIC_KEY
+#error "IMAGE_SIGNING_PUBLIC_KEY is not defined, put the production signing key in ImageKeys.h"
+#endif
+// Encrypted Transfer Settings
+#define ENCRYPTION_OFF                         0x00         // Memory write data is plaintext
+#define ENCRYPTION_AES128_CTR                  0x01         // Memory write data is AES-128-CTR encrypted
+
+// AES-128 key shared with the host encryptor (Tools/EncryptImage.c), defined in ImageKeys.h
+#ifndef IMAGE_DECRYPTION_KEY
+#error "IMAGE_DECRYPTION_KEY is not defined, put the production transfer key in ImageKeys.h"
+#endif
 /***************************************Bootloader Macros Declaration End***************************************/
 
 /*************************************Bootloader DataType Declaration Start*************************************/
@@ -86,6 +288,7 @@ typedef enum
 {
     BL_NACK,      // Negative acknowledgment
     BL_ACK,       // Positive acknowledgment
+    BL_IDLE_TIMEOUT, // No frame within IDLE_TIMEOUT, the application may be started
 } BL_status;
 
 // CRC verification status
@@ -102,6 +305,8 @@ typedef enum
     INVALID_PAGE_ADDRESS,       // Invalid page address specified
     UNSUCCESSFUL_ERASE = 0x03, // Erase operation failed
     SUCCESSFUL_ERASE = 0x02,   // Erase operation succeeded
+    ERASE_PAGE_PROTECTED = 0x04, // A requested page is write-protected, nothing was erased
+    ERASE_PAGE_RESERVED = 0x05,  // The range leaves the application region (or mass erase), nothing was erased
 } FLASH_erase_status;
 
 // Flash memory write status
@@ -109,27 +314,324 @@ typedef enum
 {
     UNSUCCESSFUL_WRITE,         // Write operation failed
     SUCCESSFUL_WRITE,           // Write operation succeeded
+    WRITE_PAGE_PROTECTED,       // The range touches a write-protected page, nothing was written
+    WRITE_PAGE_RESERVED,        // The range leaves the application region, nothing was written
 } FLASH_write_status;
 
+// SRAM write status
+typedef enum
+{
+    UNSUCCESSFUL_RAM_WRITE,     // Write operation failed (address outside the applet area)
+    SUCCESSFUL_RAM_WRITE,       // Write operation succeeded
+} RAM_write_status;
+
+// Encryption mode change status
+typedef enum
+{
+    ENCRYPTION_MODE_INVALID,    // Unknown encryption mode requested
+    ENCRYPTION_MODE_SET,        // Encryption mode changed
+} ENCRYPTION_status;
+
+// Image signature verification status
+typedef enum
+{
+    IMAGE_SIGNATURE_INVALID,    // Signature does not match the image
+    IMAGE_SIGNATURE_VALID,      // Signature verified, image marked bootable
+    INVALID_IMAGE_LENGTH,       // Image length is zero or exceeds the application region
+    IMAGE_RECORD_WRITE_FAILED,  // Signature verified but the image record could not be stored
+    IMAGE_VERSION_ROLLBACK,     // Signature verified but the image is older than the version counter
+} IMAGE_verify_status;
+
+// Record stored in IMAGE_INFO_PAGE_ADDRESS once an image is verified
+typedef struct
+{
+    uint32 Magic;                           // IMAGE_INFO_MAGIC
+    uint32 Length;                          // Image length in bytes from FLASH_SECTOR2_BASE_ADDRESS
+    uint8  Digest[SHA256_DIGEST_SIZE];      // SHA-256 of the verified image
+    uint8  Signature[ED25519_SIGNATURE_SIZE]; // Signature over Digest, checked again at every boot
+} IMAGE_info;
+
+// Application page state reported to the host
+typedef enum
+{
+    PAGE_STATE_ERASED,          // Every byte of the page is 0xFF
+    PAGE_STATE_PARTIAL,         // Page erased by the current update, holds data but was not committed by the journal
+    PAGE_STATE_COMPLETE,        // Page committed by the journal
+    PAGE_STATE_STALE,           // Page holds data the current update has not erased, the host erases it before writing
+} PAGE_state;
+
+// Per-page progress marks of the update journal, each mark is programmed once from 0xFFFF to JOURNAL_MARK_SET
+typedef struct
+{
+    uint16 Erased;                          // Page erased during the current update
+    uint16 Committed;                       // Page completely written during the current update
+} JOURNAL_page_marks;
+
+// Layout of the journal page
+typedef struct
+{
+    uint32 Magic;                                           // JOURNAL_MAGIC
+    JOURNAL_page_marks Pages[APPLICATION_PAGE_COUNT];       // One entry per application page
+} JOURNAL_info;
+
+// Frame error counters of one transport, the host sizes its frames from them
+typedef struct
+{
+    uint32 FramesPassed;                    // Frames whose CRC matched
+    uint32 FramesFailed;                    // Frames rejected by CRC_enVerify
+    uint32 BytesPassed;                     // Bytes of the passed frames, length byte and CRC included
+    uint32 BytesFailed;                     // Bytes of the failed frames, as announced by their length byte
+    uint32 BytesCorrected;                  // Bytes repaired by the Reed-Solomon decoder before the CRC check
+} LINK_stats;
+
+// Forward error correction mode change status
+typedef enum
+{
+    FEC_MODE_INVALID,           // Odd or too large parity size requested
+    FEC_MODE_SET,               // Parity size changed, applies from the next frame
+} FEC_status;
+
+// Append-only record of the anti-rollback version counter
+typedef struct
+{
+    uint16 Version;                         // Counter value
+    uint16 Check;                           // Complement of Version, detects a torn record write
+} VERSION_record;
+
 // Read Out Protection level change status
 typedef enum
 {
     ROP_LEVEL_CHANGE_INVALID,   // Invalid level change request
     ROP_LEVEL_CHANGE_VALID,     // Valid level change request
 } FLASH_CHANGE_PROTECTION_status;
+
+// Option byte bulk programming status
+typedef enum
+{
+    OPTION_BYTES_WRITE_FAILED,  // Unlock, erase or programming failed
+    OPTION_BYTES_WRITTEN,       // Option bytes programmed, the device resets to load them
+    OPTION_BYTES_INVALID_RDP,   // Requested RDP level is not supported
+} OPTION_BYTES_status;
+
+// Bootloader self-update status
+typedef enum
+{
+    BOOTLOADER_UPDATE_STARTED,          // Staged image accepted, the updater runs and resets the device
+    BOOTLOADER_UPDATE_INVALID_LENGTH,   // Length is zero or larger than the bootloader or staging region
+    BOOTLOADER_UPDATE_PROTECTED,        // Bootloader pages are write-protected
+    BOOTLOADER_UPDATE_CRC_MISMATCH,     // Staged image does not match the CRC sent by the host
+    BOOTLOADER_UPDATE_SIGNATURE_INVALID, // Signature over the staged image does not verify with the signing key
+} BOOTLOADER_update_status;
+
+/*
+ * Command frame descriptors.
+ * Frames are decoded in place from the receive buffer of their link, so every field is read through a packed
+ * struct instead of unaligned casts. The 4-byte CRC follows the last field of each frame.
+ */
+typedef __PACKED_STRUCT
+{
+    uint8 Length;                           // Number of bytes following this field, CRC included
+    uint8 Command;                          // CBL_xxx_CMD
+} CBL_frame_header;
+
+// CBL_GO_TO_ADDR_CMD
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint32 Address;                         // Target address
+} CBL_go_to_addr_frame;
+
+// CBL_FLASH_ERASE_CMD
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint8 PageNumber;                       // First page, CBL_FLASH_MASS_ERASE for a mass erase
+    uint8 NumberOfPages;                    // Number of pages to erase
+} CBL_flash_erase_frame;
+
+// CBL_MEM_WRITE_CMD and CBL_RAM_WRITE_CMD
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint32 Address;                         // Destination address
+    uint8 DataLength;                       // Number of data bytes
+    uint8 Data[];                           // Data bytes, followed by the CRC
+} CBL_mem_write_frame;
+
+// CBL_VERIFY_IMAGE_CMD
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint32 ImageLength;                     // Image length from FLASH_SECTOR2_BASE_ADDRESS
+    uint8 Signature[ED25519_SIGNATURE_SIZE];// Signature over the SHA-256 of the image
+} CBL_verify_image_frame;
+
+// CBL_SET_ENCRYPTION_CMD
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint8 Mode;                             // ENCRYPTION_OFF or ENCRYPTION_AES128_CTR
+    uint8 InitialCounter[AES128_BLOCK_SIZE];// Counter block of the first application byte
+} CBL_set_encryption_frame;
+
+// CBL_BATCH_CMD, OperationCount operations follow back to back
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint8 OperationCount;                   // Number of operations, at most BATCH_MAX_OPERATIONS
+    uint8 Operations[];                     // Operations, followed by the CRC
+} CBL_batch_frame;
+
+// BATCH_OP_ERASE
+typedef __PACKED_STRUCT
+{
+    uint8 Op;
+    uint8 PageNumber;                       // First page, CBL_FLASH_MASS_ERASE for a mass erase
+    uint8 NumberOfPages;                    // Number of pages to erase
+} CBL_batch_erase_op;
+
+// BATCH_OP_WRITE
+typedef __PACKED_STRUCT
+{
+    uint8 Op;
+    uint32 Address;                         // Destination address
+    uint8 DataLength;                       // Number of data bytes
+    uint8 Data[];                           // Data bytes
+} CBL_batch_write_op;
+
+// BATCH_OP_CRC_CHECK
+typedef __PACKED_STRUCT
+{
+    uint8 Op;
+    uint32 Address;                         // Start of the flash range
+    uint32 Length;                          // Length of the flash range in bytes
+    uint32 Crc;                             // Expected protocol CRC (one byte per CRC word) of the range
+} CBL_batch_crc_op;
+
+// BATCH_OP_JUMP
+typedef __PACKED_STRUCT
+{
+    uint8 Op;
+    uint32 Address;                         // Target address in flash or SRAM
+} CBL_batch_jump_op;
+
+// CBL_WRITE_OPTION_BYTES_CMD, the whole option byte set is replaced
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint8 RdpLevel;                         // OB_RDP_LEVEL_0 or OB_RDP_LEVEL_1
+    uint8 User;                             // USER byte (IWDG_SW, nRST_STOP, nRST_STDBY)
+    uint8 Data0;                            // User data byte 0
+    uint8 Data1;                            // User data byte 1
+    uint32 WrpMask;                         // OB_WRP_PAGESxTOy bits of the page groups to protect
+} CBL_option_bytes_frame;
+
+// CBL_UPDATE_BOOTLOADER_CMD
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint32 ImageLength;                     // Length of the staged bootloader image
+    uint32 ImageCrc;                        // Protocol CRC (one byte per CRC word) of the image
+    uint8 Signature[ED25519_SIGNATURE_SIZE]; // Ed25519 signature over the SHA-256 digest of the image
+} CBL_update_bootloader_frame;
+
+// CBL_GET_TRACE_CMD
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint8 TraceCommand;                     // Command code whose histograms are reported
+    uint8 Clear;                            // Non-zero clears them after the reply
+} CBL_get_trace_frame;
+
+// CBL_BROADCAST_WRITE_CMD
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint8 Session;                          // Broadcast session, a new value forgets the blocks of the previous one
+    uint16 Block;                           // Block number within the session, below BROADCAST_MAX_BLOCKS
+    uint32 Address;                         // Destination address
+    uint8 DataLength;                       // Number of data bytes
+    uint8 Data[];                           // Data bytes, followed by the CRC
+} CBL_broadcast_write_frame;
+
+// CBL_GET_GAP_REPORT_CMD
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint8 Session;                          // Session the report is about
+    uint16 BlockCount;                      // Number of blocks the host sent in the session
+    uint16 FirstBlock;                      // First block number listed in the reply
+} CBL_get_gap_report_frame;
+
+// CBL_GET_LINK_STATS_CMD
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint8 Clear;                            // Non-zero clears the counters after the reply
+} CBL_get_link_stats_frame;
+
+// CBL_SET_FEC_CMD
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint8 ParitySize;                       // Reed-Solomon parity bytes behind every following frame, 0 turns FEC off
+} CBL_set_fec_frame;
+
+// CBL_CHANGE_ROP_Level_CMD
+typedef __PACKED_STRUCT
+{
+    CBL_frame_header Header;
+    uint8 RopLevel;                         // Requested read out protection level
+} CBL_change_rop_frame;
+
+// Command handler, receives the frame in the receive buffer once its length and CRC were checked
+typedef void (*BL_command_handler)(uint8_t *Host_Buffer);
+
+// Command table entry, the table is indexed by command code - CBL_FIRST_CMD
+typedef struct
+{
+    BL_command_handler Handler;             // NULL for unused command codes
+    uint8 MinLength;                        // Smallest accepted frame length byte (command, fields and CRC)
+    uint8 Flags;                            // CBL_FLAG_xxx
+    const char* Name;                       // Command name for debug messages
+} BL_command_entry;
+
+/*
+ * RAM applet ABI.
+ * An applet is position-independent code (built with /ropi or -fpic) written into the applet area with
+ * CBL_RAM_WRITE_CMD and started with CBL_GO_TO_ADDR_CMD. It is called as a normal function and receives
+ * the bootloader services through a pointer, so it needs no absolute references into the bootloader image.
+ * When the applet returns, its 32-bit result is sent to the host as a second reply and the bootloader resumes
+ * the command loop.
+ */
+typedef struct
+{
+    void (*SendData)(const uint8 *Data, uint16 Length);                           // Send bytes to the host as framed replies
+    FLASH_write_status (*WriteFlash)(uint8 *Data, uint8 Length, uint32 Address);  // Program flash in half-words
+    uint32 (*CalculateCrc)(const uint8 *Data, uint32 Length);                     // Protocol CRC over a byte buffer
+} BL_AppletServices;
+
+// Applet entry point signature
+typedef uint32 (*BL_AppletEntry)(const BL_AppletServices *Services);
 /**************************************Bootloader DataType Declaration End**************************************/
 
 
 /*************************************Bootloader Function Declaration Start*************************************/
 
-// Function to print debug messages
-static void PrintMessage(const char* Format, ...);
+// Function to restore the bootloader state kept in flash (call once after reset)
+void BL_vInit(void);
 
 // Function to get command from the host
 BL_status BL_enGetCommand();
+static uint8* ReceiveFrame(void);   // Wait for a complete frame on any transport
 
 // Function to jump to the user application
 static void JumbToUserApplication();
+static uint8 Application_u8IsStartable(void);   // Stack pointer in SRAM and, with IMAGE_SIGNATURE_CHECK, a verified image
+void BL_vStartApplication(void);   // Jump to the application if it has a valid stack pointer (after BL_IDLE_TIMEOUT)
+#if (IDLE_CLOCK_STATUS == ENABLED)
+static void SetCoreClock(uint32 Copy_u32Source); // Switch SYSCLK between HSI and the PLL and follow with the UART baud rates
+#endif
 
 // Bootloader command functions
 static void Bootloader_Get_Version(uint8_t *Host_Buffer); // Get bootloader version
@@ -139,19 +641,84 @@ static void Bootloader_Read_Protection_Level(uint8_t *Host_Buffer); // Read prot
 static void Bootloader_Jump_To_Address(uint8_t *Host_Buffer); // Jump to specified address
 static void Bootloader_Erase_Flash(uint8_t *Host_Buffer);   // Erase flash memory
 static void Bootloader_Memory_Write(uint8_t *Host_Buffer);   // Write data to memory
+static void Bootloader_Ram_Write(uint8_t *Host_Buffer);      // Write an applet into SRAM
+static void Bootloader_Verify_Image(uint8_t *Host_Buffer);   // Verify the application image signature
+static void Bootloader_Set_Encryption(uint8_t *Host_Buffer); // Select plaintext or encrypted memory writes
+static void Bootloader_Get_Page_State(uint8_t *Host_Buffer); // Report the resume offset and per-page state
+static void Bootloader_Batch(uint8_t *Host_Buffer);          // Run a sequence of operations from one frame
+static void Bootloader_Write_Option_Bytes(uint8_t *Host_Buffer); // Program all option bytes with a single reset
+static void Bootloader_Set_Bootloader_Protection(uint8_t *Host_Buffer); // Protect or unprotect the bootloader pages
+static void Bootloader_Update_Bootloader(uint8_t *Host_Buffer); // Replace the bootloader with the staged image
+#if (TRACE_STATUS == ENABLED)
+static void Bootloader_Get_Trace(uint8_t *Host_Buffer);      // Report the phase timing histograms of a command
+#endif
 static void Bootloader_Change_Read_Protection_Level(uint8_t *Host_Buffer); // Change read protection level
+static void Bootloader_Broadcast_Write(uint8_t *Host_Buffer); // Write a numbered block of a broadcast update
+static void Bootloader_Get_Gap_Report(uint8_t *Host_Buffer);  // List the broadcast blocks that were not written
+static void Bootloader_Get_Link_Stats(uint8_t *Host_Buffer);  // Report the frame error counters of the link
+#if (FEC_STATUS == ENABLED)
+static void Bootloader_Set_Fec(uint8_t *Host_Buffer);         // Select the Reed-Solomon parity size of host frames
+#endif
 
 // Function to verify CRC
-static CRC_status CRC_enVerify(uint8 *Host_Buffer);
+static CRC_status CRC_enVerify(const uint8 *Host_Buffer);
+#if (FEC_STATUS == ENABLED)
+static void CorrectFrame(uint8* Frame);     // Reed-Solomon correction of a frame in place, then strip its parity
+#endif
 
 // Functions for sending acknowledgment
-static void SendAck(uint8 Copy_u8Size);   // Send positive acknowledgment
+static void SendReply(const uint8* Payload, uint8 Copy_u8Length); // Send ACK, size, payload and reply CRC in one transmission
 static void SendNAck();                     // Send negative acknowledgment
 
 // Flash memory operation functions
 static FLASH_erase_status EraseFlashPages(uint32_t Copy_u32PageAddress, uint32_t Copy_u32NumberOfPages); // Erase specified flash pages
 static FLASH_write_status WriteFlash(uint8* Host_Buffer, uint8 Copy_u8Length, uint32 Copy_u32StartAddress); // Write to flash memory
 static FLASH_CHANGE_PROTECTION_status ChangeROPLevel(uint8 Copy_u8ROPLevel); // Change read out protection level
+static OPTION_BYTES_status WriteOptionBytes(const CBL_option_bytes_frame* Copy_pstOptionBytes); // One erase, then program every option byte
+static uint8 Flash_u8IsWriteProtected(uint32 Copy_u32Address, uint32 Copy_u32Length); // Check a range against the cached WRP bitmap
+static uint8 Flash_u8IsReserved(uint32 Copy_u32Address, uint32 Copy_u32Length); // Check a host range against the application region
+static BOOTLOADER_update_status CheckStagedBootloader(uint32 Copy_u32Length, uint32 Copy_u32Crc, const uint8* Copy_pu8Signature); // Validate the staged bootloader image
+static void RunUpdater(uint32 Copy_u32Length, uint32 Copy_u32Crc);   // Start the updater from SRAM, does not return
+static FLASH_erase_status ErasePages(uint8 Copy_u8PageNumber, uint8 Copy_u8NumberOfPages); // Erase by page number and update the journal
+static FLASH_write_status MemoryWrite(uint8* Data, uint8 Copy_u8Length, uint32 Copy_u32Address); // Decrypt, program, hash and journal a block
+static uint16 RunBatch(const CBL_batch_frame* Copy_pstFrame, uint16 Copy_u16Count, uint8* Copy_pu8Results, uint32* Copy_pu32JumpAddress); // Execute batch operations
+
+// SRAM applet functions
+#if (RAM_APPLET_STATUS == ENABLED)
+static RAM_write_status WriteRam(uint8* Host_Buffer, uint8 Copy_u8Length, uint32 Copy_u32StartAddress); // Write to the applet area
+#endif
+#if (RAM_APPLET_STATUS == ENABLED)
+static void Applet_SendData(const uint8 *Data, uint16 Length);         // Applet service: send framed replies
+static FLASH_write_status Applet_WriteFlash(uint8 *Data, uint8 Length, uint32 Address); // Applet service: program flash
+#endif
+
+// Data path functions (also exported to applets)
+static void SendData(const uint8 *Data, uint16 Length);                 // Send raw bytes to the host on the active transport
+static uint32 CalculateCrc(const uint8 *Data, uint32 Length);           // Protocol CRC over a byte buffer
+static void FeedCrc(const uint8 *Data, uint32 Length);                  // Add bytes to the CRC in progress
+// Signed image functions
+static void Image_vTrackWrite(const uint8* Data, uint8 Copy_u8Length, uint32 Copy_u32Address); // Stream written data into the image hash
+static IMAGE_verify_status VerifyImage(uint32 Copy_u32ImageLength, const uint8* Copy_pu8Signature); // Check the image signature
+static uint8 Image_u8IsBootable(void);   // Check the stored image record against the flash contents
+
+// Anti-rollback functions
+static uint16 ReadVersionCounter(void);                          // Current value of the version counter
+static uint16 FindVersionSlot(uint32 Copy_u32PageAddress);       // First erased record slot of a version counter page
+static uint16 ReadVersionPage(uint32 Copy_u32PageAddress);       // Newest valid record of a version counter page
+static FLASH_write_status WriteVersionCounter(uint16 Copy_u16Version); // Append a new version counter record
+
+// Update journal functions
+static void Journal_vReset(void);                                                // Start a new update transaction
+static void Journal_vRecordErase(uint32 Copy_u32PageAddress, uint32 Copy_u32NumberOfPages); // Mark erased application pages
+static void Journal_vResumeWrite(uint32 Copy_u32Address);                        // Continue the committed prefix after a reset
+static uint32 Journal_u32ProgrammedWords(uint32 Copy_u32PageAddress);            // Words before the trailing erased run of a page
+static uint8 Journal_u8IsErased(uint32 Copy_u32Page);                            // Check the erased mark of an application page
+static void Journal_vRecordWrite(uint32 Copy_u32Address, uint8 Copy_u8Length);   // Mark completely written application pages
+static uint16 GetPageState(uint8* Copy_pu8Reply);                                // Build the page state reply, returns its length
+
+// Encrypted transfer functions
+static ENCRYPTION_status SetEncryptionMode(uint8 Copy_u8Mode, const uint8* Copy_pu8InitialCounter); // Change the transfer mode
+static FLASH_write_status DecryptFrame(uint8* Data, uint8 Copy_u8Length, uint32 Copy_u32Address);   // Decrypt write data in place
 /**************************************Bootloader Function Declaration End**************************************/
 
 
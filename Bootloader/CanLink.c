@@ -0,0 +1,519 @@
+#include"CanLink.h"
+#include<string.h>
+
+// ISO-TP protocol control information, the high nibble of the first data byte
+#define ISOTP_SINGLE_FRAME                     0x0u
+#define ISOTP_FIRST_FRAME                      0x1u
+#define ISOTP_CONSECUTIVE_FRAME                0x2u
+#define ISOTP_FLOW_CONTROL                     0x3u
+#define ISOTP_FLOW_CONTINUE                    0x0u         // Flow status: clear to send
+#define ISOTP_FLOW_WAIT                        0x1u         // Flow status: wait for the next flow control
+#define ISOTP_FLOW_OVERFLOW                    0x2u         // Flow status: message too long, abort
+#define CAN_FRAME_SIZE                         8u
+
+CAN_HandleTypeDef hcan;
+
+// Reassembled messages, written at the head by the RX FIFO 1 interrupt and taken at the tail.
+// Indices run freely, the slot behind the tail holds the frame being handled and is never reused early
+static uint8 Global_u8arrCanSlots[CAN_RX_SLOTS][CAN_MESSAGE_MAX];
+static uint8 Global_u8arrCanBroadcast[CAN_RX_SLOTS];   // Message arrived on CAN_BROADCAST_ID
+static volatile uint8 Global_u8CanHead = 0;            // Written by the RX interrupt only
+static volatile uint8 Global_u8CanTail = 0;            // Written by CanLink_pu8Receive only
+
+// Message being reassembled by the RX interrupt
+static uint8 Global_u8RxActive = 0;
+static uint32 Global_u32RxId = 0;
+static uint16 Global_u16RxLength = 0;
+static uint16 Global_u16RxReceived = 0;
+static uint8 Global_u8RxSequence = 0;
+
+// Last flow control frame from the host, consumed by CanLink_vSend
+static volatile uint8 Global_u8FlowReceived = 0;
+static volatile uint8 Global_u8FlowStatus = 0;
+static volatile uint8 Global_u8FlowBlockSize = 0;
+static volatile uint8 Global_u8FlowStMin = 0;
+
+static uint8 Global_u8NodeId = CAN_DEFAULT_NODE_ID;
+static uint8 Global_u8ReplyDropped = 0;                // The frame being handled was broadcast
+
+/**
+ * @brief  Queues one CAN frame in a free transmit mailbox.
+ *         Interrupts are masked around the HAL call because the RX interrupt sends flow control frames too.
+ * @retval uint8: 1 if the frame was queued, 0 if no mailbox freed up in time.
+ */
+static uint8 CanLink_u8SendFrame(const uint8* Copy_pu8Data, uint8 Copy_u8Dlc)
+{
+    CAN_TxHeaderTypeDef Local_stHeader = {0};
+    uint32_t Local_u32Mailbox = 0;          // HAL type, uint32 is unsigned long
+    uint32 Local_u32Start = HAL_GetTick();
+    uint32 Local_u32Primask = __get_PRIMASK();
+    HAL_StatusTypeDef Local_enStatus = HAL_ERROR;
+
+    Local_stHeader.StdId = CAN_RESPONSE_BASE_ID + Global_u8NodeId;
+    Local_stHeader.IDE = CAN_ID_STD;
+    Local_stHeader.RTR = CAN_RTR_DATA;
+    Local_stHeader.DLC = Copy_u8Dlc;
+
+    while (HAL_CAN_GetTxMailboxesFreeLevel(CAN_PORT) == 0u)
+    {
+        if ((HAL_GetTick() - Local_u32Start) > CAN_ISOTP_TIMEOUT)
+        {
+            return 0;
+        }
+    }
+
+    __disable_irq();
+    Local_enStatus = HAL_CAN_AddTxMessage(CAN_PORT, &Local_stHeader, (uint8*)Copy_pu8Data, &Local_u32Mailbox);
+    __set_PRIMASK(Local_u32Primask);
+
+    return (uint8)(Local_enStatus == HAL_OK);
+}
+
+/**
+ * @brief  Answers a first frame from the host with a flow control frame. Called from the RX interrupt.
+ * @retval None
+ */
+static void CanLink_vSendFlowControl(uint8 Copy_u8FlowStatus)
+{
+    uint8 Local_u8arrFrame[3] = { (uint8)((ISOTP_FLOW_CONTROL << 4) | Copy_u8FlowStatus), 0u, CAN_ISOTP_STMIN };
+
+    // Block size 0: the host sends every consecutive frame without waiting for another flow control
+    if (HAL_CAN_GetTxMailboxesFreeLevel(CAN_PORT) > 0u)
+    {
+        CanLink_u8SendFrame(Local_u8arrFrame, sizeof(Local_u8arrFrame));
+    }
+}
+
+/**
+ * @brief  Returns 1 if a new message may be reassembled at the head without touching the frame being handled.
+ * @retval uint8
+ */
+static uint8 CanLink_u8SlotFree(void)
+{
+    return (uint8)((uint8)(Global_u8CanHead - Global_u8CanTail) < (CAN_RX_SLOTS - 1u));
+}
+
+/**
+ * @brief  Publishes the message reassembled at the head. Messages whose length byte does not match the
+ *         ISO-TP length are dropped, so the engine never reads past a message.
+ * @retval None
+ */
+static void CanLink_vPublish(uint16 Copy_u16Length, uint8 Copy_u8Broadcast)
+{
+    uint8 Local_u8Slot = Global_u8CanHead & (CAN_RX_SLOTS - 1u);
+
+    if (((uint16)Global_u8arrCanSlots[Local_u8Slot][0] + 1u) == Copy_u16Length)
+    {
+        Global_u8arrCanBroadcast[Local_u8Slot] = Copy_u8Broadcast;
+        Global_u8CanHead++;
+    }
+}
+
+/**
+ * @brief  Feeds one received CAN frame into the ISO-TP reassembly. Called from the RX interrupt.
+ *         A single or first frame aborts a message still in progress, a consecutive frame out of
+ *         sequence aborts it too. Broadcast messages are never answered with flow control, the host
+ *         paces their consecutive frames itself.
+ * @retval None
+ */
+static void CanLink_vOnFrame(uint32 Copy_u32Id, const uint8* Copy_pu8Data, uint8 Copy_u8Dlc)
+{
+    uint8 Local_u8Broadcast = (uint8)(Copy_u32Id == CAN_BROADCAST_ID);
+    uint8* Local_pu8Slot = Global_u8arrCanSlots[Global_u8CanHead & (CAN_RX_SLOTS - 1u)];
+    uint16 Local_u16Copy = 0;
+
+    if (Copy_u8Dlc == 0u)
+    {
+        return;
+    }
+
+    switch (Copy_pu8Data[0] >> 4)
+    {
+    case ISOTP_SINGLE_FRAME:
+        Global_u8RxActive = 0;
+        Local_u16Copy = Copy_pu8Data[0] & 0x0Fu;
+        if ((Local_u16Copy != 0u) && (Local_u16Copy < Copy_u8Dlc) && CanLink_u8SlotFree())
+        {
+            memcpy(Local_pu8Slot, &Copy_pu8Data[1], Local_u16Copy);
+            CanLink_vPublish(Local_u16Copy, Local_u8Broadcast);
+        }
+        break;
+
+    case ISOTP_FIRST_FRAME:
+        Global_u8RxActive = 0;
+        Global_u16RxLength = (uint16)(((Copy_pu8Data[0] & 0x0Fu) << 8) | Copy_pu8Data[1]);
+        if ((Copy_u8Dlc == CAN_FRAME_SIZE) && (Global_u16RxLength >= CAN_FRAME_SIZE) &&
+            (Global_u16RxLength <= CAN_MESSAGE_MAX) && CanLink_u8SlotFree())
+        {
+            memcpy(Local_pu8Slot, &Copy_pu8Data[2], CAN_FRAME_SIZE - 2u);
+            Global_u16RxReceived = CAN_FRAME_SIZE - 2u;
+            Global_u8RxSequence = 1;
+            Global_u32RxId = Copy_u32Id;
+            Global_u8RxActive = 1;
+            if (!Local_u8Broadcast)
+            {
+                CanLink_vSendFlowControl(ISOTP_FLOW_CONTINUE);
+            }
+        }
+        else if (!Local_u8Broadcast)
+        {
+            CanLink_vSendFlowControl(ISOTP_FLOW_OVERFLOW);
+        }
+        break;
+
+    case ISOTP_CONSECUTIVE_FRAME:
+        if (Global_u8RxActive && (Copy_u32Id == Global_u32RxId))
+        {
+            if ((Copy_pu8Data[0] & 0x0Fu) != Global_u8RxSequence)
+            {
+                Global_u8RxActive = 0;
+                break;
+            }
+            Local_u16Copy = Global_u16RxLength - Global_u16RxReceived;
+            if (Local_u16Copy > (uint16)(Copy_u8Dlc - 1u))
+            {
+                Local_u16Copy = Copy_u8Dlc - 1u;
+            }
+            memcpy(&Local_pu8Slot[Global_u16RxReceived], &Copy_pu8Data[1], Local_u16Copy);
+            Global_u16RxReceived += Local_u16Copy;
+            Global_u8RxSequence = (Global_u8RxSequence + 1u) & 0x0Fu;
+            if (Global_u16RxReceived == Global_u16RxLength)
+            {
+                Global_u8RxActive = 0;
+                CanLink_vPublish(Global_u16RxLength, Local_u8Broadcast);
+            }
+        }
+        break;
+
+    case ISOTP_FLOW_CONTROL:
+        if (!Local_u8Broadcast && (Copy_u8Dlc >= 3u))
+        {
+            Global_u8FlowStatus = Copy_pu8Data[0] & 0x0Fu;
+            Global_u8FlowBlockSize = Copy_pu8Data[1];
+            Global_u8FlowStMin = Copy_pu8Data[2];
+            Global_u8FlowReceived = 1;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief  Starts bxCAN at 500 kbit/s on PB8 (RX) and PB9 (TX) and routes the broadcast ID and this node's
+ *         request ID to RX FIFO 1, whose interrupt does not share a vector with USB. The node ID is the
+ *         DATA0 option byte. CubeMX cannot enable USB and CAN together, so the peripheral is set up here.
+ * @retval None
+ */
+void CanLink_vInit(void)
+{
+    CAN_FilterTypeDef Local_stFilter = {0};
+    uint8 Local_u8NodeId = (uint8)HAL_FLASHEx_OBGetUserData(OB_DATA_ADDRESS_DATA0);
+
+    if ((Local_u8NodeId != 0u) && (Local_u8NodeId <= CAN_MAX_NODE_ID))
+    {
+        Global_u8NodeId = Local_u8NodeId;
+    }
+
+    hcan.Instance = CAN1;
+    hcan.Init.Prescaler = CAN_PRESCALER;
+    hcan.Init.Mode = CAN_MODE_NORMAL;
+    hcan.Init.SyncJumpWidth = CAN_SJW_1TQ;
+    hcan.Init.TimeSeg1 = CAN_TIME_SEG1;
+    hcan.Init.TimeSeg2 = CAN_TIME_SEG2;
+    hcan.Init.TimeTriggeredMode = DISABLE;
+    hcan.Init.AutoBusOff = ENABLE;
+    hcan.Init.AutoWakeUp = DISABLE;
+    hcan.Init.AutoRetransmission = ENABLE;
+    hcan.Init.ReceiveFifoLocked = DISABLE;
+    hcan.Init.TransmitFifoPriority = ENABLE;   // Mailboxes leave in request order, consecutive frames stay in sequence
+    if (HAL_CAN_Init(CAN_PORT) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    // 16-bit identifier list: this node's request ID and the broadcast ID, the standard ID sits in bits 15..5
+    Local_stFilter.FilterBank = 0;
+    Local_stFilter.FilterMode = CAN_FILTERMODE_IDLIST;
+    Local_stFilter.FilterScale = CAN_FILTERSCALE_16BIT;
+    Local_stFilter.FilterIdHigh = (CAN_REQUEST_BASE_ID + Global_u8NodeId) << 5;
+    Local_stFilter.FilterIdLow = CAN_BROADCAST_ID << 5;
+    Local_stFilter.FilterMaskIdHigh = (CAN_REQUEST_BASE_ID + Global_u8NodeId) << 5;
+    Local_stFilter.FilterMaskIdLow = CAN_BROADCAST_ID << 5;
+    Local_stFilter.FilterFIFOAssignment = CAN_FILTER_FIFO1;
+    Local_stFilter.FilterActivation = ENABLE;
+    Local_stFilter.SlaveStartFilterBank = 14;
+    HAL_CAN_ConfigFilter(CAN_PORT, &Local_stFilter);
+
+    HAL_CAN_ActivateNotification(CAN_PORT, CAN_IT_RX_FIFO1_MSG_PENDING);
+    HAL_CAN_Start(CAN_PORT);
+}
+
+/**
+ * @brief  Leaves the bus and stops the bxCAN clock and interrupt before jumping to the application.
+ * @retval None
+ */
+void CanLink_vDeInit(void)
+{
+    HAL_CAN_DeInit(CAN_PORT);
+}
+
+/**
+ * @brief  Returns the number of complete messages waiting to be handled.
+ * @retval uint8
+ */
+uint8 CanLink_u8Pending(void)
+{
+    return (uint8)(Global_u8CanHead - Global_u8CanTail);
+}
+
+/**
+ * @brief  Takes the next complete message. It stays valid until the one after it is taken, and decides
+ *         whether CanLink_vSend answers (physical request) or stays silent (broadcast).
+ * @retval uint8*: Pointer to the length byte of the CBL frame, NULL if no message is pending.
+ */
+uint8* CanLink_pu8Receive(void)
+{
+    uint8 Local_u8Slot = Global_u8CanTail & (CAN_RX_SLOTS - 1u);
+
+    if (Global_u8CanHead == Global_u8CanTail)
+    {
+        return NULL;
+    }
+
+    Global_u8ReplyDropped = Global_u8arrCanBroadcast[Local_u8Slot];
+    Global_u8CanTail++;
+
+    return Global_u8arrCanSlots[Local_u8Slot];
+}
+
+/**
+ * @brief  Sends bytes to the host as one ISO-TP message on CAN_RESPONSE_BASE_ID + node ID. Messages over
+ *         7 bytes start with a first frame and wait for the host's flow control, whose block size and
+ *         separation time are honoured. Nothing is sent while a broadcast frame is handled, dozens of
+ *         nodes answering at once would only collide.
+ * @param  Data: Pointer to the bytes to send.
+ * @param  Length: Number of bytes to send, at most 4095.
+ * @retval None
+ */
+void CanLink_vSend(const uint8* Data, uint16 Length)
+{
+    uint8 Local_u8arrFrame[CAN_FRAME_SIZE];
+    uint16 Local_u16Offset = 0;
+    uint16 Local_u16Chunk = 0;
+    uint8 Local_u8Sequence = 1;
+    uint8 Local_u8BlockLeft = 0;            // Consecutive frames left before the next flow control, 0 = wait for one
+    uint8 Local_u8Unlimited = 0;            // Block size 0, no further flow control
+    uint8 Local_u8StMin = 0;
+    uint32 Local_u32Start = 0;
+
+    if (Global_u8ReplyDropped || (Length == 0u) || (Length > 0x0FFFu))
+    {
+        return;
+    }
+
+    // Step 1: Short messages fit in a single frame
+    if (Length < CAN_FRAME_SIZE)
+    {
+        Local_u8arrFrame[0] = (uint8)((ISOTP_SINGLE_FRAME << 4) | Length);
+        memcpy(&Local_u8arrFrame[1], Data, Length);
+        CanLink_u8SendFrame(Local_u8arrFrame, (uint8)(Length + 1u));
+        return;
+    }
+
+    // Step 2: First frame with the 12-bit length and the first 6 bytes
+    Global_u8FlowReceived = 0;
+    Local_u8arrFrame[0] = (uint8)((ISOTP_FIRST_FRAME << 4) | (Length >> 8));
+    Local_u8arrFrame[1] = (uint8)Length;
+    memcpy(&Local_u8arrFrame[2], Data, CAN_FRAME_SIZE - 2u);
+    Local_u16Offset = CAN_FRAME_SIZE - 2u;
+    if (!CanLink_u8SendFrame(Local_u8arrFrame, CAN_FRAME_SIZE))
+    {
+        return;
+    }
+
+    // Step 3: Consecutive frames, paced by the flow control of the host
+    while (Local_u16Offset < Length)
+    {
+        if (!Local_u8Unlimited && (Local_u8BlockLeft == 0u))
+        {
+            Local_u32Start = HAL_GetTick();
+            while (!Global_u8FlowReceived)
+            {
+                if ((HAL_GetTick() - Local_u32Start) > CAN_ISOTP_TIMEOUT)
+                {
+                    return;
+                }
+            }
+            Global_u8FlowReceived = 0;
+
+            if (Global_u8FlowStatus == ISOTP_FLOW_WAIT)
+            {
+                continue;
+            }
+            if (Global_u8FlowStatus != ISOTP_FLOW_CONTINUE)
+            {
+                return;
+            }
+
+            Local_u8BlockLeft = Global_u8FlowBlockSize;
+            Local_u8Unlimited = (uint8)(Global_u8FlowBlockSize == 0u);
+
+            // STmin up to 0x7F is in ms, 0xF1..0xF9 is 100..900 us and rounded up to 1 ms, the rest is reserved
+            Local_u8StMin = Global_u8FlowStMin;
+            if (Local_u8StMin > 0x7Fu)
+            {
+                Local_u8StMin = ((Local_u8StMin >= 0xF1u) && (Local_u8StMin <= 0xF9u)) ? 1u : 0x7Fu;
+            }
+        }
+        else if (Local_u8StMin != 0u)
+        {
+            HAL_Delay(Local_u8StMin);
+        }
+
+        Local_u16Chunk = Length - Local_u16Offset;
+        if (Local_u16Chunk > (CAN_FRAME_SIZE - 1u))
+        {
+            Local_u16Chunk = CAN_FRAME_SIZE - 1u;
+        }
+        Local_u8arrFrame[0] = (uint8)((ISOTP_CONSECUTIVE_FRAME << 4) | Local_u8Sequence);
+        memcpy(&Local_u8arrFrame[1], &Data[Local_u16Offset], Local_u16Chunk);
+        if (!CanLink_u8SendFrame(Local_u8arrFrame, (uint8)(Local_u16Chunk + 1u)))
+        {
+            return;
+        }
+
+        Local_u16Offset += Local_u16Chunk;
+        Local_u8Sequence = (Local_u8Sequence + 1u) & 0x0Fu;
+        if (!Local_u8Unlimited)
+        {
+            Local_u8BlockLeft--;
+        }
+    }
+
+}
+
+/**
+ * @brief  Transport adapter: non-zero once a complete message is waiting.
+ * @retval uint8
+ */
+static uint8 CanLink_u8Receiving(void)
+{
+    return (uint8)(CanLink_u8Pending() != 0u);
+}
+
+/**
+ * @brief  Transport adapter: nothing to drop, CanLink_u8Receiving() only reports complete messages.
+ * @retval None
+ */
+static void CanLink_vDiscard(void)
+{
+}
+
+/**
+ * @brief  Transport adapter: the segments are staged and sent as one ISO-TP message.
+ * @retval None
+ */
+static void CanLink_vSendGather(const TRANSPORT_segment* Segments, uint8 Count)
+{
+    Transport_vSendGatherCopy(Segments, Count, CanLink_vSend);
+}
+
+/**
+ * @brief  Transport adapter: waits for the last frames to leave the mailboxes before the caller jumps or resets.
+ * @retval None
+ */
+static void CanLink_vFlush(void)
+{
+    uint32 Local_u32Start = HAL_GetTick();
+
+    while ((HAL_CAN_GetTxMailboxesFreeLevel(CAN_PORT) < 3u) && ((HAL_GetTick() - Local_u32Start) <= CAN_ISOTP_TIMEOUT))
+    {
+    }
+}
+
+/**
+ * @brief  Transport adapter: nominal bit rate of the bus.
+ * @retval uint32: bit/s
+ */
+static uint32 CanLink_u32LinkSpeed(void)
+{
+    return CAN_BITRATE;
+}
+
+const TRANSPORT_backend CanLink_stTransport =
+{
+    CanLink_u8Receiving,
+    CanLink_pu8Receive,
+    CanLink_vDiscard,
+    CanLink_vSend,
+    CanLink_vSendGather,
+    CanLink_vFlush,
+    CanLink_u32LinkSpeed,
+};
+
+/**
+ * @brief  RX FIFO 1 message pending callback of the HAL CAN driver, drains the FIFO into the reassembly.
+ * @param  hcan: CAN handle that received a message.
+ * @retval None
+ */
+void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan)
+{
+    CAN_RxHeaderTypeDef Local_stHeader;
+    uint8 Local_u8arrData[CAN_FRAME_SIZE];
+
+    while (HAL_CAN_GetRxFifoFillLevel(hcan, CAN_RX_FIFO1) > 0u)
+    {
+        if ((HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO1, &Local_stHeader, Local_u8arrData) == HAL_OK) &&
+            (Local_stHeader.IDE == CAN_ID_STD) && (Local_stHeader.RTR == CAN_RTR_DATA))
+        {
+            CanLink_vOnFrame(Local_stHeader.StdId, Local_u8arrData, (uint8)Local_stHeader.DLC);
+        }
+    }
+}
+
+/**
+ * @brief  bxCAN MSP setup: clock, remapped pins PB8/PB9 and the RX FIFO 1 interrupt.
+ * @retval None
+ */
+void HAL_CAN_MspInit(CAN_HandleTypeDef* canHandle)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    if (canHandle->Instance == CAN1)
+    {
+        __HAL_RCC_CAN1_CLK_ENABLE();
+        __HAL_RCC_GPIOB_CLK_ENABLE();
+        __HAL_RCC_AFIO_CLK_ENABLE();
+
+        GPIO_InitStruct.Pin = GPIO_PIN_8;
+        GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+        GPIO_InitStruct.Pull = GPIO_NOPULL;
+        HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+        GPIO_InitStruct.Pin = GPIO_PIN_9;
+        GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+        GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+        HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+        __HAL_AFIO_REMAP_CAN1_2();
+
+        HAL_NVIC_SetPriority(CAN1_RX1_IRQn, 0, 0);
+        HAL_NVIC_EnableIRQ(CAN1_RX1_IRQn);
+    }
+}
+
+/**
+ * @brief  bxCAN MSP teardown.
+ * @retval None
+ */
+void HAL_CAN_MspDeInit(CAN_HandleTypeDef* canHandle)
+{
+    if (canHandle->Instance == CAN1)
+    {
+        __HAL_RCC_CAN1_CLK_DISABLE();
+        HAL_GPIO_DeInit(GPIOB, GPIO_PIN_8 | GPIO_PIN_9);
+        HAL_NVIC_DisableIRQ(CAN1_RX1_IRQn);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef CANLINK_H
+#define CANLINK_H
+
+/********************************************Library Include Start********************************************/
+#include "STD_TYPES.h"   // Standard type definitions
+#include "main.h"        // HAL CAN driver
+#include "Transport.h"   // Transport backend interface
+/********************************************Library Include End********************************************/
+
+/**************************************CanLink Macros Declaration Start**************************************/
+#define CAN_PORT                               &hcan        // bxCAN handle
+#define CAN_REQUEST_BASE_ID                    0x400u       // Host to node frames use 0x400 + node ID
+#define CAN_RESPONSE_BASE_ID                   0x480u       // Node to host frames use 0x480 + node ID
+#define CAN_BROADCAST_ID                       CAN_REQUEST_BASE_ID // Host to every node, never answered
+#define CAN_DEFAULT_NODE_ID                    0x7Fu        // Node ID used while the DATA0 option byte is erased or invalid
+#define CAN_MAX_NODE_ID                        0x7Fu        // Node IDs are 1..127, 0 is the broadcast address
+#define CAN_RX_SLOTS                           4u           // Reassembled messages, one is kept for the frame being handled
+#define CAN_MESSAGE_MAX                        256u         // Largest ISO-TP message, one CBL frame
+#define CAN_ISOTP_STMIN                        0u           // Separation time requested from the host in flow control (ms)
+#define CAN_ISOTP_TIMEOUT                      1000u        // ms to wait for a flow control frame or a free mailbox
+
+#define CAN_BITRATE                            500000u      // Bus bit rate set by the timing below
+
+// Bit timing for 500 kbit/s from the 36 MHz APB1 clock: 36 MHz / 4 / (1 + 15 + 2) tq, sample point at 88.9 %
+#define CAN_PRESCALER                          4u
+#define CAN_TIME_SEG1                          CAN_BS1_15TQ
+#define CAN_TIME_SEG2                          CAN_BS2_2TQ
+/***************************************CanLink Macros Declaration End***************************************/
+
+/*************************************CanLink Variable Declaration Start*************************************/
+extern CAN_HandleTypeDef hcan;
+extern const TRANSPORT_backend CanLink_stTransport;            // ISO-TP messages as a transport backend
+/**************************************CanLink Variable Declaration End**************************************/
+
+/*************************************CanLink Function Declaration Start*************************************/
+void CanLink_vInit(void);                                       // Start bxCAN on PB8/PB9 and accept this node's IDs
+void CanLink_vDeInit(void);                                     // Stop bxCAN before leaving the bootloader
+uint8 CanLink_u8Pending(void);                                  // Complete messages waiting to be handled
+uint8* CanLink_pu8Receive(void);                                // Take the next message, NULL if there is none
+void CanLink_vSend(const uint8* Data, uint16 Length);           // Send one ISO-TP message, dropped after a broadcast
+/**************************************CanLink Function Declaration End**************************************/
+
+#endif
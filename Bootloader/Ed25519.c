@@ -0,0 +1,605 @@
+#include"Ed25519.h"
+#include<string.h>
+
+/*
+ * Compact Ed25519 verifier in the style of TweetNaCl: field elements are sixteen 16-bit limbs held in
+ * 64-bit integers, points use extended twisted Edwards coordinates with the unified addition law.
+ * Only public data is processed, so the double scalar multiplication is not constant time.
+ * Points and large temporaries live in static storage to keep the verifier within the 1 KB main stack.
+ */
+
+typedef int64_t ED25519_field[16];
+
+/**************************************SHA-512 (used internally by Ed25519)**************************************/
+
+// Round constants (first 64 bits of the fractional parts of the cube roots of the first 80 primes)
+static const uint64_t Global_u64arrRoundConstants[80] =
+{
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+#define SHA512_ROTR(x, n)                      (((x) >> (n)) | ((x) << (64u - (n))))
+#define SHA512_BLOCK_SIZE                      128u         // Size of one SHA-512 message block in bytes
+
+typedef struct
+{
+    uint64_t State[8];
+    uint64_t TotalLength;
+    uint8_t  Block[SHA512_BLOCK_SIZE];
+    uint32_t BlockLength;
+} SHA512_context;
+
+static void SHA512_vCompress(uint64_t *State, const uint8_t *Block)
+{
+    static uint64_t Local_u64arrSchedule[80];
+    uint64_t a, b, c, d, e, f, g, h, Local_u64Temp1, Local_u64Temp2;
+    uint8_t Local_u8Counter, Local_u8Byte;
+
+    for (Local_u8Counter = 0; Local_u8Counter < 16; Local_u8Counter++)
+    {
+        Local_u64arrSchedule[Local_u8Counter] = 0;
+        for (Local_u8Byte = 0; Local_u8Byte < 8; Local_u8Byte++)
+        {
+            Local_u64arrSchedule[Local_u8Counter] = (Local_u64arrSchedule[Local_u8Counter] << 8) | Block[8 * Local_u8Counter + Local_u8Byte];
+        }
+    }
+    for (Local_u8Counter = 16; Local_u8Counter < 80; Local_u8Counter++)
+    {
+        uint64_t Local_u64W15 = Local_u64arrSchedule[Local_u8Counter - 15];
+        uint64_t Local_u64W2 = Local_u64arrSchedule[Local_u8Counter - 2];
+        Local_u64arrSchedule[Local_u8Counter] = Local_u64arrSchedule[Local_u8Counter - 16] + Local_u64arrSchedule[Local_u8Counter - 7] +
+                                                (SHA512_ROTR(Local_u64W15, 1) ^ SHA512_ROTR(Local_u64W15, 8) ^ (Local_u64W15 >> 7)) +
+                                                (SHA512_ROTR(Local_u64W2, 19) ^ SHA512_ROTR(Local_u64W2, 61) ^ (Local_u64W2 >> 6));
+    }
+
+    a = State[0]; b = State[1]; c = State[2]; d = State[3];
+    e = State[4]; f = State[5]; g = State[6]; h = State[7];
+    for (Local_u8Counter = 0; Local_u8Counter < 80; Local_u8Counter++)
+    {
+        Local_u64Temp1 = h + (SHA512_ROTR(e, 14) ^ SHA512_ROTR(e, 18) ^ SHA512_ROTR(e, 41)) + ((e & f) ^ (~e & g)) +
+                         Global_u64arrRoundConstants[Local_u8Counter] + Local_u64arrSchedule[Local_u8Counter];
+        Local_u64Temp2 = (SHA512_ROTR(a, 28) ^ SHA512_ROTR(a, 34) ^ SHA512_ROTR(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + Local_u64Temp1;
+        d = c; c = b; b = a; a = Local_u64Temp1 + Local_u64Temp2;
+    }
+
+    State[0] += a; State[1] += b; State[2] += c; State[3] += d;
+    State[4] += e; State[5] += f; State[6] += g; State[7] += h;
+}
+
+static void SHA512_vInit(SHA512_context *Context)
+{
+    Context->State[0] = 0x6a09e667f3bcc908ULL;
+    Context->State[1] = 0xbb67ae8584caa73bULL;
+    Context->State[2] = 0x3c6ef372fe94f82bULL;
+    Context->State[3] = 0xa54ff53a5f1d36f1ULL;
+    Context->State[4] = 0x510e527fade682d1ULL;
+    Context->State[5] = 0x9b05688c2b3e6c1fULL;
+    Context->State[6] = 0x1f83d9abfb41bd6bULL;
+    Context->State[7] = 0x5be0cd19137e2179ULL;
+    Context->TotalLength = 0;
+    Context->BlockLength = 0;
+}
+
+static void SHA512_vUpdate(SHA512_context *Context, const uint8_t *Data, uint32_t Length)
+{
+    Context->TotalLength += Length;
+    while (Length > 0)
+    {
+        Context->Block[Context->BlockLength++] = *Data++;
+        Length--;
+        if (Context->BlockLength == SHA512_BLOCK_SIZE)
+        {
+            SHA512_vCompress(Context->State, Context->Block);
+            Context->BlockLength = 0;
+        }
+    }
+}
+
+static void SHA512_vFinal(SHA512_context *Context, uint8_t *Digest)
+{
+    uint64_t Local_u64BitLength = Context->TotalLength * 8u;
+    uint8_t Local_u8Counter;
+
+    // The 128-bit length field never exceeds 64 bits here, its upper half stays zero
+    Context->Block[Context->BlockLength++] = 0x80;
+    if (Context->BlockLength > (SHA512_BLOCK_SIZE - 16u))
+    {
+        memset(Context->Block + Context->BlockLength, 0, SHA512_BLOCK_SIZE - Context->BlockLength);
+        SHA512_vCompress(Context->State, Context->Block);
+        Context->BlockLength = 0;
+    }
+    memset(Context->Block + Context->BlockLength, 0, SHA512_BLOCK_SIZE - Context->BlockLength);
+    for (Local_u8Counter = 0; Local_u8Counter < 8; Local_u8Counter++)
+    {
+        Context->Block[SHA512_BLOCK_SIZE - 1u - Local_u8Counter] = (uint8_t)(Local_u64BitLength >> (8u * Local_u8Counter));
+    }
+    SHA512_vCompress(Context->State, Context->Block);
+
+    for (Local_u8Counter = 0; Local_u8Counter < 64; Local_u8Counter++)
+    {
+        Digest[Local_u8Counter] = (uint8_t)(Context->State[Local_u8Counter >> 3] >> (56u - 8u * (Local_u8Counter & 7u)));
+    }
+}
+
+/**************************************Field arithmetic modulo 2^255 - 19**************************************/
+
+static const ED25519_field Global_FieldZero = {0};
+static const ED25519_field Global_FieldOne = {1};
+
+// Curve constant d = -121665/121666
+static const ED25519_field Global_FieldD =
+{
+    0x78a3, 0x1359, 0x4dca, 0x75eb, 0xd8ab, 0x4141, 0x0a4d, 0x0070,
+    0xe898, 0x7779, 0x4079, 0x8cc7, 0xfe73, 0x2b6f, 0x6cee, 0x5203
+};
+
+// 2 * d
+static const ED25519_field Global_FieldD2 =
+{
+    0xf159, 0x26b2, 0x9b94, 0xebd6, 0xb156, 0x8283, 0x149a, 0x00e0,
+    0xd130, 0xeef3, 0x80f2, 0x198e, 0xfce7, 0x56df, 0xd9dc, 0x2406
+};
+
+// Base point coordinates
+static const ED25519_field Global_FieldBaseX =
+{
+    0xd51a, 0x8f25, 0x2d60, 0xc956, 0xa7b2, 0x9525, 0xc760, 0x692c,
+    0xdc5c, 0xfdd6, 0xe231, 0xc0a4, 0x53fe, 0xcd6e, 0x36d3, 0x2169
+};
+static const ED25519_field Global_FieldBaseY =
+{
+    0x6658, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666,
+    0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666
+};
+
+// Square root of -1
+static const ED25519_field Global_FieldSqrtM1 =
+{
+    0xa0b0, 0x4a0e, 0x1b27, 0xc4ee, 0xe478, 0xad2f, 0x1806, 0x2f43,
+    0xd7a7, 0x3dfb, 0x0099, 0x2b4d, 0xdf0b, 0x4fc1, 0x2480, 0x2b83
+};
+
+static void Field_vCopy(ED25519_field Out, const ED25519_field In)
+{
+    memcpy(Out, In, sizeof(ED25519_field));
+}
+
+// Propagate carries so every limb is back in 16 bits, folding the top carry with 2^256 = 38
+static void Field_vCarry(ED25519_field Out)
+{
+    int64_t Local_s64Carry;
+    uint8_t Local_u8Counter;
+
+    for (Local_u8Counter = 0; Local_u8Counter < 16; Local_u8Counter++)
+    {
+        Out[Local_u8Counter] += ((int64_t)1 << 16);
+        Local_s64Carry = Out[Local_u8Counter] >> 16;
+        if (Local_u8Counter < 15)
+        {
+            Out[Local_u8Counter + 1] += Local_s64Carry - 1;
+        }
+        else
+        {
+            Out[0] += 38 * (Local_s64Carry - 1);
+        }
+        Out[Local_u8Counter] -= Local_s64Carry * 65536;
+    }
+}
+
+static void Field_vSelect(ED25519_field P, ED25519_field Q, int64_t Bit)
+{
+    int64_t Local_s64Mask = ~(Bit - 1);
+    int64_t Local_s64Temp;
+    uint8_t Local_u8Counter;
+
+    for (Local_u8Counter = 0; Local_u8Counter < 16; Local_u8Counter++)
+    {
+        Local_s64Temp = Local_s64Mask & (P[Local_u8Counter] ^ Q[Local_u8Counter]);
+        P[Local_u8Counter] ^= Local_s64Temp;
+        Q[Local_u8Counter] ^= Local_s64Temp;
+    }
+}
+
+// Fully reduce and encode as 32 little-endian bytes
+static void Field_vPack(uint8_t *Out, const ED25519_field In)
+{
+    ED25519_field Local_Minus, Local_Temp;
+    int64_t Local_s64Borrow;
+    uint8_t Local_u8Counter, Local_u8Pass;
+
+    Field_vCopy(Local_Temp, In);
+    Field_vCarry(Local_Temp);
+    Field_vCarry(Local_Temp);
+    Field_vCarry(Local_Temp);
+    for (Local_u8Pass = 0; Local_u8Pass < 2; Local_u8Pass++)
+    {
+        Local_Minus[0] = Local_Temp[0] - 0xffed;
+        for (Local_u8Counter = 1; Local_u8Counter < 15; Local_u8Counter++)
+        {
+            Local_Minus[Local_u8Counter] = Local_Temp[Local_u8Counter] - 0xffff - ((Local_Minus[Local_u8Counter - 1] >> 16) & 1);
+            Local_Minus[Local_u8Counter - 1] &= 0xffff;
+        }
+        Local_Minus[15] = Local_Temp[15] - 0x7fff - ((Local_Minus[14] >> 16) & 1);
+        Local_s64Borrow = (Local_Minus[15] >> 16) & 1;
+        Local_Minus[14] &= 0xffff;
+        Field_vSelect(Local_Temp, Local_Minus, 1 - Local_s64Borrow);
+    }
+    for (Local_u8Counter = 0; Local_u8Counter < 16; Local_u8Counter++)
+    {
+        Out[2 * Local_u8Counter] = (uint8_t)(Local_Temp[Local_u8Counter] & 0xff);
+        Out[2 * Local_u8Counter + 1] = (uint8_t)(Local_Temp[Local_u8Counter] >> 8);
+    }
+}
+
+static void Field_vUnpack(ED25519_field Out, const uint8_t *In)
+{
+    uint8_t Local_u8Counter;
+
+    for (Local_u8Counter = 0; Local_u8Counter < 16; Local_u8Counter++)
+    {
+        Out[Local_u8Counter] = In[2 * Local_u8Counter] + ((int64_t)In[2 * Local_u8Counter + 1] << 8);
+    }
+    Out[15] &= 0x7fff;
+}
+
+// Returns non-zero when the two elements differ
+static uint8_t Field_u8NotEqual(const ED25519_field A, const ED25519_field B)
+{
+    uint8_t Local_u8arrA[32], Local_u8arrB[32];
+
+    Field_vPack(Local_u8arrA, A);
+    Field_vPack(Local_u8arrB, B);
+    return (uint8_t)(memcmp(Local_u8arrA, Local_u8arrB, 32) != 0);
+}
+
+static uint8_t Field_u8Parity(const ED25519_field A)
+{
+    uint8_t Local_u8arrBytes[32];
+
+    Field_vPack(Local_u8arrBytes, A);
+    return Local_u8arrBytes[0] & 1u;
+}
+
+static void Field_vAdd(ED25519_field Out, const ED25519_field A, const ED25519_field B)
+{
+    uint8_t Local_u8Counter;
+
+    for (Local_u8Counter = 0; Local_u8Counter < 16; Local_u8Counter++)
+    {
+        Out[Local_u8Counter] = A[Local_u8Counter] + B[Local_u8Counter];
+    }
+}
+
+static void Field_vSub(ED25519_field Out, const ED25519_field A, const ED25519_field B)
+{
+    uint8_t Local_u8Counter;
+
+    for (Local_u8Counter = 0; Local_u8Counter < 16; Local_u8Counter++)
+    {
+        Out[Local_u8Counter] = A[Local_u8Counter] - B[Local_u8Counter];
+    }
+}
+
+static void Field_vMul(ED25519_field Out, const ED25519_field A, const ED25519_field B)
+{
+    int64_t Local_s64arrProduct[31] = {0};
+    uint8_t i, j;
+
+    for (i = 0; i < 16; i++)
+    {
+        for (j = 0; j < 16; j++)
+        {
+            Local_s64arrProduct[i + j] += A[i] * B[j];
+        }
+    }
+    for (i = 0; i < 15; i++)
+    {
+        Local_s64arrProduct[i] += 38 * Local_s64arrProduct[i + 16];
+    }
+    for (i = 0; i < 16; i++)
+    {
+        Out[i] = Local_s64arrProduct[i];
+    }
+    Field_vCarry(Out);
+    Field_vCarry(Out);
+}
+
+static void Field_vSquare(ED25519_field Out, const ED25519_field A)
+{
+    Field_vMul(Out, A, A);
+}
+
+// Out = In^(p - 2), the multiplicative inverse
+static void Field_vInvert(ED25519_field Out, const ED25519_field In)
+{
+    ED25519_field Local_Acc;
+    int16_t Local_s16Bit;
+
+    Field_vCopy(Local_Acc, In);
+    for (Local_s16Bit = 253; Local_s16Bit >= 0; Local_s16Bit--)
+    {
+        Field_vSquare(Local_Acc, Local_Acc);
+        if ((Local_s16Bit != 2) && (Local_s16Bit != 4))
+        {
+            Field_vMul(Local_Acc, Local_Acc, In);
+        }
+    }
+    Field_vCopy(Out, Local_Acc);
+}
+
+// Out = In^((p - 5) / 8), used for the square root when decoding points
+static void Field_vPow2523(ED25519_field Out, const ED25519_field In)
+{
+    ED25519_field Local_Acc;
+    int16_t Local_s16Bit;
+
+    Field_vCopy(Local_Acc, In);
+    for (Local_s16Bit = 250; Local_s16Bit >= 0; Local_s16Bit--)
+    {
+        Field_vSquare(Local_Acc, Local_Acc);
+        if (Local_s16Bit != 1)
+        {
+            Field_vMul(Local_Acc, Local_Acc, In);
+        }
+    }
+    Field_vCopy(Out, Local_Acc);
+}
+
+/**************************************Group operations**************************************/
+
+// Extended coordinates (X, Y, Z, T) with x = X/Z, y = Y/Z, x*y = T/Z
+typedef ED25519_field ED25519_point[4];
+
+// P = P + Q, the unified formula also handles doubling and the neutral element
+static void Point_vAdd(ED25519_point P, ED25519_point Q)
+{
+    static ED25519_field a, b, c, d, t, e, f, g, h;
+
+    Field_vSub(a, P[1], P[0]);
+    Field_vSub(t, Q[1], Q[0]);
+    Field_vMul(a, a, t);
+    Field_vAdd(b, P[0], P[1]);
+    Field_vAdd(t, Q[0], Q[1]);
+    Field_vMul(b, b, t);
+    Field_vMul(c, P[3], Q[3]);
+    Field_vMul(c, c, Global_FieldD2);
+    Field_vMul(d, P[2], Q[2]);
+    Field_vAdd(d, d, d);
+    Field_vSub(e, b, a);
+    Field_vSub(f, d, c);
+    Field_vAdd(g, d, c);
+    Field_vAdd(h, b, a);
+
+    Field_vMul(P[0], e, f);
+    Field_vMul(P[1], h, g);
+    Field_vMul(P[2], g, f);
+    Field_vMul(P[3], e, h);
+}
+
+// Encode a point as the y coordinate with the sign of x in the top bit
+static void Point_vPack(uint8_t *Out, ED25519_point P)
+{
+    static ED25519_field Local_ZInverse, Local_X, Local_Y;
+
+    Field_vInvert(Local_ZInverse, P[2]);
+    Field_vMul(Local_X, P[0], Local_ZInverse);
+    Field_vMul(Local_Y, P[1], Local_ZInverse);
+    Field_vPack(Out, Local_Y);
+    Out[31] ^= (uint8_t)(Field_u8Parity(Local_X) << 7);
+}
+
+// Decode a point and negate it, returns non-zero when the encoding is not on the curve
+static uint8_t Point_u8UnpackNegate(ED25519_point R, const uint8_t *In)
+{
+    static ED25519_field Local_Temp, Local_Check, Local_Num, Local_Den, Local_Den2, Local_Den4, Local_Den6;
+
+    Field_vCopy(R[2], Global_FieldOne);
+    Field_vUnpack(R[1], In);
+    Field_vSquare(Local_Num, R[1]);
+    Field_vMul(Local_Den, Local_Num, Global_FieldD);
+    Field_vSub(Local_Num, Local_Num, R[2]);
+    Field_vAdd(Local_Den, R[2], Local_Den);
+
+    Field_vSquare(Local_Den2, Local_Den);
+    Field_vSquare(Local_Den4, Local_Den2);
+    Field_vMul(Local_Den6, Local_Den4, Local_Den2);
+    Field_vMul(Local_Temp, Local_Den6, Local_Num);
+    Field_vMul(Local_Temp, Local_Temp, Local_Den);
+
+    Field_vPow2523(Local_Temp, Local_Temp);
+    Field_vMul(Local_Temp, Local_Temp, Local_Num);
+    Field_vMul(Local_Temp, Local_Temp, Local_Den);
+    Field_vMul(Local_Temp, Local_Temp, Local_Den);
+    Field_vMul(R[0], Local_Temp, Local_Den);
+
+    Field_vSquare(Local_Check, R[0]);
+    Field_vMul(Local_Check, Local_Check, Local_Den);
+    if (Field_u8NotEqual(Local_Check, Local_Num))
+    {
+        Field_vMul(R[0], R[0], Global_FieldSqrtM1);
+    }
+
+    Field_vSquare(Local_Check, R[0]);
+    Field_vMul(Local_Check, Local_Check, Local_Den);
+    if (Field_u8NotEqual(Local_Check, Local_Num))
+    {
+        return 1;
+    }
+
+    if (Field_u8Parity(R[0]) == (In[31] >> 7))
+    {
+        Field_vSub(R[0], Global_FieldZero, R[0]);
+    }
+    Field_vMul(R[3], R[0], R[1]);
+    return 0;
+}
+
+/**************************************Scalar arithmetic modulo the group order L**************************************/
+
+static const int64_t Global_s64arrGroupOrder[32] =
+{
+    0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x10
+};
+
+// Reduce a 64-byte little-endian number modulo L into 32 bytes
+static void Scalar_vReduce(uint8_t *Out, const uint8_t *In)
+{
+    static int64_t Local_s64arrX[64];
+    int64_t Local_s64Carry;
+    int16_t i, j;
+
+    for (i = 0; i < 64; i++)
+    {
+        Local_s64arrX[i] = In[i];
+    }
+    for (i = 63; i >= 32; --i)
+    {
+        Local_s64Carry = 0;
+        for (j = i - 32; j < i - 12; ++j)
+        {
+            Local_s64arrX[j] += Local_s64Carry - 16 * Local_s64arrX[i] * Global_s64arrGroupOrder[j - (i - 32)];
+            Local_s64Carry = (Local_s64arrX[j] + 128) >> 8;
+            Local_s64arrX[j] -= Local_s64Carry * 256;
+        }
+        Local_s64arrX[j] += Local_s64Carry;
+        Local_s64arrX[i] = 0;
+    }
+    Local_s64Carry = 0;
+    for (j = 0; j < 32; j++)
+    {
+        Local_s64arrX[j] += Local_s64Carry - (Local_s64arrX[31] >> 4) * Global_s64arrGroupOrder[j];
+        Local_s64Carry = Local_s64arrX[j] >> 8;
+        Local_s64arrX[j] &= 255;
+    }
+    for (j = 0; j < 32; j++)
+    {
+        Local_s64arrX[j] -= Local_s64Carry * Global_s64arrGroupOrder[j];
+    }
+    for (i = 0; i < 32; i++)
+    {
+        Local_s64arrX[i + 1] += Local_s64arrX[i] >> 8;
+        Out[i] = (uint8_t)(Local_s64arrX[i] & 255);
+    }
+}
+
+// Returns non-zero when the 32-byte little-endian scalar is canonical (strictly below L)
+static uint8_t Scalar_u8IsCanonical(const uint8_t *Scalar)
+{
+    int8_t Local_s8Counter;
+
+    for (Local_s8Counter = 31; Local_s8Counter >= 0; Local_s8Counter--)
+    {
+        if (Scalar[Local_s8Counter] < Global_s64arrGroupOrder[Local_s8Counter])
+        {
+            return 1;
+        }
+        if (Scalar[Local_s8Counter] > Global_s64arrGroupOrder[Local_s8Counter])
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/**************************************Verification**************************************/
+
+// Working points, kept static so verification does not need kilobytes of stack
+static ED25519_point Global_Result, Global_NegKey, Global_Base, Global_KeyPlusBase;
+
+/**
+ * @brief  Verifies an Ed25519 signature as defined by RFC 8032.
+ *
+ * The check [S]B == R + [k]A is evaluated as [k](-A) + [S]B in a single double-and-add pass
+ * (Straus/Shamir), sharing the 256 doublings between both scalars.
+ *
+ * @param  Signature: The 64-byte signature (encoded R followed by the scalar S).
+ * @param  Message: Pointer to the signed message.
+ * @param  MessageLength: Length of the message in bytes.
+ * @param  PublicKey: The 32-byte encoded public key A.
+ * @retval SIGNATURE_status: SIGNATURE_VALID if the signature matches, otherwise SIGNATURE_INVALID.
+ */
+SIGNATURE_status ED25519_enVerify(const uint8_t *Signature, const uint8_t *Message, uint32_t MessageLength,
+                                  const uint8_t *PublicKey)
+{
+    static SHA512_context Local_stHash;
+    uint8_t Local_u8arrDigest[64];
+    uint8_t Local_u8arrK[32];
+    uint8_t Local_u8arrCheck[32];
+    int16_t Local_s16Bit;
+
+    // Step 1: Reject malleable signatures and keys that are not valid curve points
+    if (!Scalar_u8IsCanonical(Signature + 32))
+    {
+        return SIGNATURE_INVALID;
+    }
+    if (Point_u8UnpackNegate(Global_NegKey, PublicKey))
+    {
+        return SIGNATURE_INVALID;
+    }
+
+    // Step 2: k = SHA-512(R || A || M) mod L
+    SHA512_vInit(&Local_stHash);
+    SHA512_vUpdate(&Local_stHash, Signature, 32);
+    SHA512_vUpdate(&Local_stHash, PublicKey, ED25519_PUBLIC_KEY_SIZE);
+    SHA512_vUpdate(&Local_stHash, Message, MessageLength);
+    SHA512_vFinal(&Local_stHash, Local_u8arrDigest);
+    Scalar_vReduce(Local_u8arrK, Local_u8arrDigest);
+
+    // Step 3: Prepare B and (-A + B) for the joint scalar multiplication
+    Field_vCopy(Global_Base[0], Global_FieldBaseX);
+    Field_vCopy(Global_Base[1], Global_FieldBaseY);
+    Field_vCopy(Global_Base[2], Global_FieldOne);
+    Field_vMul(Global_Base[3], Global_FieldBaseX, Global_FieldBaseY);
+    memcpy(Global_KeyPlusBase, Global_NegKey, sizeof(ED25519_point));
+    Point_vAdd(Global_KeyPlusBase, Global_Base);
+
+    // Step 4: Result = [k](-A) + [S]B, starting from the neutral element (0, 1, 1, 0)
+    Field_vCopy(Global_Result[0], Global_FieldZero);
+    Field_vCopy(Global_Result[1], Global_FieldOne);
+    Field_vCopy(Global_Result[2], Global_FieldOne);
+    Field_vCopy(Global_Result[3], Global_FieldZero);
+    for (Local_s16Bit = 255; Local_s16Bit >= 0; Local_s16Bit--)
+    {
+        uint8_t Local_u8KBit = (Local_u8arrK[Local_s16Bit >> 3] >> (Local_s16Bit & 7)) & 1u;
+        uint8_t Local_u8SBit = (Signature[32 + (Local_s16Bit >> 3)] >> (Local_s16Bit & 7)) & 1u;
+
+        Point_vAdd(Global_Result, Global_Result);
+        if (Local_u8KBit && Local_u8SBit)
+        {
+            Point_vAdd(Global_Result, Global_KeyPlusBase);
+        }
+        else if (Local_u8KBit)
+        {
+            Point_vAdd(Global_Result, Global_NegKey);
+        }
+        else if (Local_u8SBit)
+        {
+            Point_vAdd(Global_Result, Global_Base);
+        }
+    }
+
+    // Step 5: The encoding of the result must equal R
+    Point_vPack(Local_u8arrCheck, Global_Result);
+    return (memcmp(Local_u8arrCheck, Signature, 32) == 0) ? SIGNATURE_VALID : SIGNATURE_INVALID;
+}
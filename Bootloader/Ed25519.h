@@ -0,0 +1,28 @@
+#ifndef ED25519_H
+#define ED25519_H
+
+/********************************************Library Include Start********************************************/
+#include <stdint.h>      // Fixed width types used by the field arithmetic
+/********************************************Library Include End********************************************/
+
+/**************************************Ed25519 Macros Declaration Start**************************************/
+#define ED25519_PUBLIC_KEY_SIZE                32u          // Size of an encoded public key in bytes
+#define ED25519_SIGNATURE_SIZE                 64u          // Size of a signature (R || S) in bytes
+/***************************************Ed25519 Macros Declaration End***************************************/
+
+/*************************************Ed25519 DataType Declaration Start*************************************/
+// Signature verification status
+typedef enum
+{
+    SIGNATURE_INVALID,      // Signature does not match the message and key
+    SIGNATURE_VALID,        // Signature verified
+} SIGNATURE_status;
+/**************************************Ed25519 DataType Declaration End**************************************/
+
+/*************************************Ed25519 Function Declaration Start*************************************/
+// Verify an Ed25519 (RFC 8032) signature over a message
+SIGNATURE_status ED25519_enVerify(const uint8_t *Signature, const uint8_t *Message, uint32_t MessageLength,
+                                  const uint8_t *PublicKey);
+/**************************************Ed25519 Function Declaration End**************************************/
+
+#endif
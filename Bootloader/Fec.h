@@ -0,0 +1,19 @@
+#ifndef FEC_H
+#define FEC_H
+
+/********************************************Library Include Start********************************************/
+#include <stdint.h>      // Fixed width types used by the decoder
+/********************************************Library Include End********************************************/
+
+/****************************************FEC Macros Declaration Start****************************************/
+#define FEC_MAX_CODEWORD_SIZE                  255u         // Longest Reed-Solomon codeword over GF(2^8)
+#define FEC_MAX_PARITY_SIZE                    32u          // Parity bytes per codeword, corrects up to half as many byte errors
+#define FEC_UNCORRECTABLE                      0xFFu        // Returned when the errors exceed the correction capacity
+/*****************************************FEC Macros Declaration End*****************************************/
+
+/***************************************FEC Function Declaration Start***************************************/
+// Correct a systematic RS codeword in place (parity in its last ParitySize bytes), returns the corrected byte count
+uint8_t FEC_u8Decode(uint8_t *Codeword, uint16_t Length, uint8_t ParitySize);
+/****************************************FEC Function Declaration End****************************************/
+
+#endif
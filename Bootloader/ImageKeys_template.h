@@ -0,0 +1,22 @@
+#ifndef IMAGE_KEYS_H
+#define IMAGE_KEYS_H
+
+/*
+ * Copy this file to ImageKeys.h and fill in the keys of the product. ImageKeys.h is not part of the
+ * repository and the bootloader does not build without it, so no image is ever shipped with a
+ * published test key.
+ */
+
+/*****************************************Image Keys Declaration Start*****************************************/
+// Ed25519 public key of the image signing authority (32 bytes)
+// #define IMAGE_SIGNING_PUBLIC_KEY               { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+//                                                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+//                                                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+//                                                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }
+
+// AES-128 key of encrypted transfers, shared with Tools/EncryptImage.c (16 bytes)
+// #define IMAGE_DECRYPTION_KEY                   { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+//                                                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }
+/******************************************Image Keys Declaration End******************************************/
+
+#endif
@@ -0,0 +1,111 @@
+#include"Log.h"
+
+// Record ring drained by the TX DMA channel of LOG_PORT, the text of a record is never formatted on the
+// target. Indices run freely and are masked on access, Head - Tail is the number of queued bytes
+static uint8 Global_u8arrLogRing[LOG_RING_SIZE];
+static volatile uint16 Global_u16LogHead = 0;      // Written by Log_vWrite only
+static volatile uint16 Global_u16LogTail = 0;      // Written by the transfer complete callback only
+static volatile uint16 Global_u16LogChunk = 0;     // Length of the DMA transfer in progress, 0 when idle
+static uint32 Global_u32LogDropped = 0;            // Records lost because the ring was full
+
+/**
+ * @brief  Starts a DMA transfer of the queued bytes up to the end of the ring.
+ *         Called with interrupts masked or from the transfer complete callback.
+ * @retval None
+ */
+static void Log_vStart(void)
+{
+    uint16 Local_u16Queued = (uint16)(Global_u16LogHead - Global_u16LogTail);
+    uint16 Local_u16Offset = Global_u16LogTail & (LOG_RING_SIZE - 1u);
+    uint16 Local_u16Chunk = LOG_RING_SIZE - Local_u16Offset;
+
+    if ((Global_u16LogChunk == 0) && (Local_u16Queued > 0))
+    {
+        if (Local_u16Chunk > Local_u16Queued)
+        {
+            Local_u16Chunk = Local_u16Queued;
+        }
+        Global_u16LogChunk = Local_u16Chunk;
+        HAL_UART_Transmit_DMA(LOG_PORT, &Global_u8arrLogRing[Local_u16Offset], Local_u16Chunk);
+    }
+}
+
+/**
+ * @brief  Copies one record into the ring.
+ * @retval None
+ */
+static void Log_vPut(LOG_id Copy_enId, uint32 Copy_u32Argument)
+{
+    LOG_record Local_stRecord = { LOG_SYNC, (uint8)Copy_enId, Copy_u32Argument };
+    const uint8* Local_pu8Record = (const uint8*)&Local_stRecord;
+    uint16 Local_u16Head = Global_u16LogHead;
+    uint8 Local_u8Counter = 0;
+
+    for (Local_u8Counter = 0; Local_u8Counter < sizeof(LOG_record); Local_u8Counter++)
+    {
+        Global_u8arrLogRing[(Local_u16Head + Local_u8Counter) & (LOG_RING_SIZE - 1u)] = Local_pu8Record[Local_u8Counter];
+    }
+
+    // Publish the record only once all of its bytes are in the ring
+    Global_u16LogHead = Local_u16Head + sizeof(LOG_record);
+}
+
+/**
+ * @brief  Queues a record and starts the DMA drain if it is idle. A full ring drops the record and
+ *         counts it, the count is reported with LOG_RECORDS_DROPPED once there is room again.
+ * @param  Copy_enId: Message identifier.
+ * @param  Copy_u32Argument: Value printed by the host in place of the format specifier.
+ * @retval None
+ */
+void Log_vWrite(LOG_id Copy_enId, uint32 Copy_u32Argument)
+{
+    uint16 Local_u16Free = LOG_RING_SIZE - (uint16)(Global_u16LogHead - Global_u16LogTail);
+    uint32 Local_u32Primask = __get_PRIMASK();
+
+    if ((Global_u32LogDropped > 0) && (Local_u16Free >= (2u * sizeof(LOG_record))))
+    {
+        Log_vPut(LOG_RECORDS_DROPPED, Global_u32LogDropped);
+        Global_u32LogDropped = 0;
+        Local_u16Free -= sizeof(LOG_record);
+    }
+
+    if ((Global_u32LogDropped == 0) && (Local_u16Free >= sizeof(LOG_record)))
+    {
+        Log_vPut(Copy_enId, Copy_u32Argument);
+    }
+    else
+    {
+        Global_u32LogDropped++;
+    }
+
+    // The callback may start the next transfer at any time, so the idle check runs with interrupts masked
+    __disable_irq();
+    Log_vStart();
+    __set_PRIMASK(Local_u32Primask);
+}
+
+/**
+ * @brief  Waits until every queued record has left the debug UART, used before jumping away or resetting.
+ *         Interrupts must be enabled.
+ * @retval None
+ */
+void Log_vFlush(void)
+{
+    while (Global_u16LogHead != Global_u16LogTail);
+    while (!__HAL_UART_GET_FLAG(LOG_PORT, UART_FLAG_TC));
+}
+
+/**
+ * @brief  Transfer complete callback of the HAL UART driver, releases the sent bytes and sends the rest.
+ * @param  huart: UART handle that completed a transmission.
+ * @retval None
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart == LOG_PORT)
+    {
+        Global_u16LogTail += Global_u16LogChunk;
+        Global_u16LogChunk = 0;
+        Log_vStart();
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef LOG_H
+#define LOG_H
+
+/********************************************Library Include Start********************************************/
+#include "STD_TYPES.h"   // Standard type definitions
+#include "usart.h"       // Debug UART handle
+/********************************************Library Include End********************************************/
+
+/****************************************Log Macros Declaration Start****************************************/
+#define LOG_PORT                               &huart2      // Debug UART, drained by its TX DMA channel
+#define LOG_RING_SIZE                          256u         // Record ring size in bytes (power of two)
+#define LOG_SYNC                               0x5Au        // First byte of every record on the wire
+
+/*
+ * Message dictionary: identifier and the text the host prints for it, with the record argument in
+ * place of the format specifier. Only the identifiers are built into the firmware, the host decoder
+ * reads the texts from this table.
+ */
+#define LOG_MESSAGES(X)                                                                 \
+    X(LOG_IMAGE_NOT_VERIFIED,           "Image Not Verified")                           \
+    X(LOG_JOURNAL_RESUME_PAGE,          "Journal Resume Page %u")                       \
+    X(LOG_UNKNOWN_COMMAND,              "Unknown Command 0x%02X")                       \
+    X(LOG_INVALID_FRAME,                "Invalid Frame, Command 0x%02X")                \
+    X(LOG_HANDLING_COMMAND,             "Handling Command 0x%02X")                      \
+    X(LOG_RUNNING_RAM_APPLET,           "Running RAM Applet")                           \
+    X(LOG_JUMPING_TO_ADDRESS,           "Jumping TO The Address 0x%08X")                \
+    X(LOG_INVALID_ADDRESS,              "Invalid Address 0x%08X")                       \
+    X(LOG_BATCH_JUMPING_TO_ADDRESS,     "Batch Jumping TO The Address 0x%08X")          \
+    X(LOG_CRC_FAILED,                   "CRC_FAILED")                                   \
+    X(LOG_CRC_PASSED,                   "CRC_PASSED")                                   \
+    X(LOG_ERASE_PAGE_PROTECTED,         "ERASE_PAGE_PROTECTED")                         \
+    X(LOG_ERASE_PAGE_RESERVED,          "ERASE_PAGE_RESERVED")                          \
+    X(LOG_SUCCESSFUL_MASS_ERASE,        "SUCCESSFUL_MASS_ERASE")                        \
+    X(LOG_UNSUCCESSFUL_MASS_ERASE,      "UNSUCCESSFUL_MASS_ERASE")                      \
+    X(LOG_SUCCESSFUL_ERASE,             "SUCCESSFUL_ERASE")                             \
+    X(LOG_UNSUCCESSFUL_ERASE,           "UNSUCCESSFUL_ERASE")                           \
+    X(LOG_INVALID_PAGE_NUMBER,          "INVALID_PAGE_NUMBER")                          \
+    X(LOG_INVALID_PAGE_ADDRESS,         "INVALID_PAGE_ADDRESS")                         \
+    X(LOG_WRITE_PAGE_PROTECTED,         "WRITE_PAGE_PROTECTED")                         \
+    X(LOG_WRITE_PAGE_RESERVED,          "WRITE_PAGE_RESERVED 0x%08X")                   \
+    X(LOG_SUCCESSFUL_WRITE,             "Successful Write")                             \
+    X(LOG_UNSUCCESSFUL_WRITE,           "Unsuccessful Write")                           \
+    X(LOG_INVALID_FLASH_ADDRESS,        "INVALID_ADDRESS 0x%08X")                       \
+    X(LOG_SUCCESSFUL_OB_UNLOCK,         "Successful_OB_Unlock")                         \
+    X(LOG_SUCCESSFUL_ROP_CHANGE,        "Successful_ROP_CHANGE")                        \
+    X(LOG_SUCCESSFUL_OB_LOCK,           "Successful_OB_Lock")                           \
+    X(LOG_UNSUCCESSFUL_OB_LOCK,         "Unsuccessful_OB_Lock")                         \
+    X(LOG_UNSUCCESSFUL_ROP_CHANGE,      "UnSuccessful_ROP_CHANGE")                      \
+    X(LOG_UNSUCCESSFUL_OB_UNLOCK,       "Unsuccessful_OB_Unlock")                       \
+    X(LOG_INVALID_RDP_LEVEL,            "INVALID_RDP_LEVEL 0x%02X")                     \
+    X(LOG_SUCCESSFUL_OB_WRITE,          "Successful_OB_Write")                          \
+    X(LOG_UNSUCCESSFUL_OB_WRITE,        "Unsuccessful_OB_Write")                        \
+    X(LOG_BOOTLOADER_UPDATE_STATUS,     "Bootloader Update Status %u")                  \
+    X(LOG_SUCCESSFUL_RAM_WRITE,         "Successful RAM Write")                         \
+    X(LOG_INVALID_RAM_ADDRESS,          "INVALID_RAM_ADDRESS 0x%08X")                   \
+    X(LOG_INVALID_IMAGE_LENGTH,         "INVALID_IMAGE_LENGTH %u")                      \
+    X(LOG_IMAGE_VERSION_ROLLBACK,       "IMAGE_VERSION_ROLLBACK %u")                    \
+    X(LOG_IMAGE_SIGNATURE_VALID,        "IMAGE_SIGNATURE_VALID")                        \
+    X(LOG_IMAGE_RECORD_WRITE_FAILED,    "IMAGE_RECORD_WRITE_FAILED")                    \
+    X(LOG_IMAGE_SIGNATURE_INVALID,      "IMAGE_SIGNATURE_INVALID")                      \
+    X(LOG_ENCRYPTION_AES128_CTR,        "ENCRYPTION_AES128_CTR")                        \
+    X(LOG_ENCRYPTION_OFF,               "ENCRYPTION_OFF")                               \
+    X(LOG_ENCRYPTION_MODE_INVALID,      "ENCRYPTION_MODE_INVALID %u")                   \
+    X(LOG_INVALID_ENCRYPTED_ADDRESS,    "INVALID_ENCRYPTED_ADDRESS 0x%08X")             \
+    X(LOG_RECORDS_DROPPED,              "%u Records Dropped")                           \
+    X(LOG_LINK_CHANGED,                 "Frame Received On A Link At %u bit/s")         \
+    X(LOG_RS485_NODE_ID,                "RS-485 Node ID %u")                            \
+    X(LOG_FEC_CORRECTED,                "FEC Corrected %u Bytes")                       \
+    X(LOG_IDLE_TIMEOUT,                 "No Frame For %u ms, Starting The Application") \
+    X(LOG_FRAME_TIMEOUT,                "Frame Incomplete After %u ms, Dropped")        \
+    X(LOG_CORE_CLOCK,                   "Core Clock %u Hz")
+/*****************************************Log Macros Declaration End*****************************************/
+
+/***************************************Log DataType Declaration Start***************************************/
+#define LOG_ID_ENTRY(ID, TEXT)                 ID,
+typedef enum
+{
+    LOG_MESSAGES(LOG_ID_ENTRY)
+    LOG_MESSAGE_COUNT
+} LOG_id;
+#undef LOG_ID_ENTRY
+
+// Record as sent on the debug UART, the argument is little-endian
+typedef __PACKED_STRUCT
+{
+    uint8 Sync;                             // LOG_SYNC
+    uint8 Id;                               // LOG_id
+    uint32 Argument;                        // Value for the format specifier, 0 if the text has none
+} LOG_record;
+/****************************************Log DataType Declaration End****************************************/
+
+/***************************************Log Function Declaration Start***************************************/
+void Log_vWrite(LOG_id Copy_enId, uint32 Copy_u32Argument);    // Queue a record, never blocks
+void Log_vFlush(void);                                          // Wait until every queued record is sent
+/****************************************Log Function Declaration End****************************************/
+
+#endif
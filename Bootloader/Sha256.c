@@ -0,0 +1,168 @@
+#include"Sha256.h"
+#include<string.h>
+
+// Round constants (first 32 bits of the fractional parts of the cube roots of the first 64 primes)
+static const uint32_t Global_u32arrRoundConstants[64] =
+{
+    0x428a2f98U, 0x71374491U, 0xb5c0fbcfU, 0xe9b5dba5U, 0x3956c25bU, 0x59f111f1U, 0x923f82a4U, 0xab1c5ed5U,
+    0xd807aa98U, 0x12835b01U, 0x243185beU, 0x550c7dc3U, 0x72be5d74U, 0x80deb1feU, 0x9bdc06a7U, 0xc19bf174U,
+    0xe49b69c1U, 0xefbe4786U, 0x0fc19dc6U, 0x240ca1ccU, 0x2de92c6fU, 0x4a7484aaU, 0x5cb0a9dcU, 0x76f988daU,
+    0x983e5152U, 0xa831c66dU, 0xb00327c8U, 0xbf597fc7U, 0xc6e00bf3U, 0xd5a79147U, 0x06ca6351U, 0x14292967U,
+    0x27b70a85U, 0x2e1b2138U, 0x4d2c6dfcU, 0x53380d13U, 0x650a7354U, 0x766a0abbU, 0x81c2c92eU, 0x92722c85U,
+    0xa2bfe8a1U, 0xa81a664bU, 0xc24b8b70U, 0xc76c51a3U, 0xd192e819U, 0xd6990624U, 0xf40e3585U, 0x106aa070U,
+    0x19a4c116U, 0x1e376c08U, 0x2748774cU, 0x34b0bcb5U, 0x391c0cb3U, 0x4ed8aa4aU, 0x5b9cca4fU, 0x682e6ff3U,
+    0x748f82eeU, 0x78a5636fU, 0x84c87814U, 0x8cc70208U, 0x90befffaU, 0xa4506cebU, 0xbef9a3f7U, 0xc67178f2U
+};
+
+#define SHA256_ROTR(x, n)                      (((x) >> (n)) | ((x) << (32u - (n))))
+
+/**
+ * @brief  Compresses one 64-byte message block into the hash state.
+ * @param  State: The eight 32-bit words of the intermediate hash value.
+ * @param  Block: Pointer to the 64-byte message block.
+ * @retval None
+ */
+static void SHA256_vCompress(uint32_t *State, const uint8_t *Block)
+{
+    uint32_t Local_u32arrSchedule[64];
+    uint32_t a, b, c, d, e, f, g, h;
+    uint32_t Local_u32Temp1, Local_u32Temp2;
+    uint8_t Local_u8Counter;
+
+    // Step 1: Load the block as big-endian words and expand the message schedule
+    for (Local_u8Counter = 0; Local_u8Counter < 16; Local_u8Counter++)
+    {
+        Local_u32arrSchedule[Local_u8Counter] = ((uint32_t)Block[4 * Local_u8Counter] << 24) |
+                                                ((uint32_t)Block[4 * Local_u8Counter + 1] << 16) |
+                                                ((uint32_t)Block[4 * Local_u8Counter + 2] << 8) |
+                                                ((uint32_t)Block[4 * Local_u8Counter + 3]);
+    }
+    for (Local_u8Counter = 16; Local_u8Counter < 64; Local_u8Counter++)
+    {
+        uint32_t Local_u32W15 = Local_u32arrSchedule[Local_u8Counter - 15];
+        uint32_t Local_u32W2 = Local_u32arrSchedule[Local_u8Counter - 2];
+        Local_u32arrSchedule[Local_u8Counter] = Local_u32arrSchedule[Local_u8Counter - 16] + Local_u32arrSchedule[Local_u8Counter - 7] +
+                                                (SHA256_ROTR(Local_u32W15, 7) ^ SHA256_ROTR(Local_u32W15, 18) ^ (Local_u32W15 >> 3)) +
+                                                (SHA256_ROTR(Local_u32W2, 17) ^ SHA256_ROTR(Local_u32W2, 19) ^ (Local_u32W2 >> 10));
+    }
+
+    // Step 2: Run the 64 rounds
+    a = State[0]; b = State[1]; c = State[2]; d = State[3];
+    e = State[4]; f = State[5]; g = State[6]; h = State[7];
+    for (Local_u8Counter = 0; Local_u8Counter < 64; Local_u8Counter++)
+    {
+        Local_u32Temp1 = h + (SHA256_ROTR(e, 6) ^ SHA256_ROTR(e, 11) ^ SHA256_ROTR(e, 25)) + ((e & f) ^ (~e & g)) +
+                         Global_u32arrRoundConstants[Local_u8Counter] + Local_u32arrSchedule[Local_u8Counter];
+        Local_u32Temp2 = (SHA256_ROTR(a, 2) ^ SHA256_ROTR(a, 13) ^ SHA256_ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + Local_u32Temp1;
+        d = c; c = b; b = a; a = Local_u32Temp1 + Local_u32Temp2;
+    }
+
+    // Step 3: Add the compressed chunk to the current hash value
+    State[0] += a; State[1] += b; State[2] += c; State[3] += d;
+    State[4] += e; State[5] += f; State[6] += g; State[7] += h;
+}
+
+/**
+ * @brief  Initializes a SHA-256 context with the standard initial hash value.
+ * @param  Context: Pointer to the context to initialize.
+ * @retval None
+ */
+void SHA256_vInit(SHA256_context *Context)
+{
+    Context->State[0] = 0x6a09e667U;
+    Context->State[1] = 0xbb67ae85U;
+    Context->State[2] = 0x3c6ef372U;
+    Context->State[3] = 0xa54ff53aU;
+    Context->State[4] = 0x510e527fU;
+    Context->State[5] = 0x9b05688cU;
+    Context->State[6] = 0x1f83d9abU;
+    Context->State[7] = 0x5be0cd19U;
+    Context->TotalLength = 0;
+    Context->BlockLength = 0;
+}
+
+/**
+ * @brief  Feeds data into the hash. Full blocks are compressed straight from the caller buffer,
+ *         so hashing a received frame costs no extra copy except for the partial block at its ends.
+ * @param  Context: Pointer to an initialized context.
+ * @param  Data: Pointer to the data to hash.
+ * @param  Length: Number of bytes to hash.
+ * @retval None
+ */
+void SHA256_vUpdate(SHA256_context *Context, const uint8_t *Data, uint32_t Length)
+{
+    uint32_t Local_u32Chunk = 0;
+
+    Context->TotalLength += Length;
+
+    // Step 1: Complete a partially filled block first
+    if (Context->BlockLength > 0)
+    {
+        Local_u32Chunk = SHA256_BLOCK_SIZE - Context->BlockLength;
+        if (Local_u32Chunk > Length)
+        {
+            Local_u32Chunk = Length;
+        }
+        memcpy(Context->Block + Context->BlockLength, Data, Local_u32Chunk);
+        Context->BlockLength += Local_u32Chunk;
+        Data += Local_u32Chunk;
+        Length -= Local_u32Chunk;
+
+        if (Context->BlockLength == SHA256_BLOCK_SIZE)
+        {
+            SHA256_vCompress(Context->State, Context->Block);
+            Context->BlockLength = 0;
+        }
+    }
+
+    // Step 2: Compress whole blocks directly from the input
+    while (Length >= SHA256_BLOCK_SIZE)
+    {
+        SHA256_vCompress(Context->State, Data);
+        Data += SHA256_BLOCK_SIZE;
+        Length -= SHA256_BLOCK_SIZE;
+    }
+
+    // Step 3: Keep the tail for the next call
+    if (Length > 0)
+    {
+        memcpy(Context->Block, Data, Length);
+        Context->BlockLength = Length;
+    }
+}
+
+/**
+ * @brief  Appends the padding and the message length, then writes the big-endian digest.
+ * @param  Context: Pointer to the context, it must be initialized again before reuse.
+ * @param  Digest: Output buffer of SHA256_DIGEST_SIZE bytes.
+ * @retval None
+ */
+void SHA256_vFinal(SHA256_context *Context, uint8_t *Digest)
+{
+    uint64_t Local_u64BitLength = Context->TotalLength * 8u;
+    uint8_t Local_u8Counter;
+
+    // Step 1: Append the 0x80 terminator and pad with zeros up to the length field
+    Context->Block[Context->BlockLength++] = 0x80;
+    if (Context->BlockLength > (SHA256_BLOCK_SIZE - 8u))
+    {
+        memset(Context->Block + Context->BlockLength, 0, SHA256_BLOCK_SIZE - Context->BlockLength);
+        SHA256_vCompress(Context->State, Context->Block);
+        Context->BlockLength = 0;
+    }
+    memset(Context->Block + Context->BlockLength, 0, (SHA256_BLOCK_SIZE - 8u) - Context->BlockLength);
+
+    // Step 2: Append the message length in bits as a big-endian 64-bit value
+    for (Local_u8Counter = 0; Local_u8Counter < 8; Local_u8Counter++)
+    {
+        Context->Block[SHA256_BLOCK_SIZE - 1u - Local_u8Counter] = (uint8_t)(Local_u64BitLength >> (8u * Local_u8Counter));
+    }
+    SHA256_vCompress(Context->State, Context->Block);
+
+    // Step 3: Output the state as big-endian bytes
+    for (Local_u8Counter = 0; Local_u8Counter < SHA256_DIGEST_SIZE; Local_u8Counter++)
+    {
+        Digest[Local_u8Counter] = (uint8_t)(Context->State[Local_u8Counter >> 2] >> (24u - 8u * (Local_u8Counter & 3u)));
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+/********************************************Library Include Start********************************************/
+#include <stdint.h>      // Fixed width types used by the hash arithmetic
+/********************************************Library Include End********************************************/
+
+/**************************************SHA-256 Macros Declaration Start**************************************/
+#define SHA256_BLOCK_SIZE                      64u          // Size of one SHA-256 message block in bytes
+#define SHA256_DIGEST_SIZE                     32u          // Size of the SHA-256 digest in bytes
+/***************************************SHA-256 Macros Declaration End***************************************/
+
+/*************************************SHA-256 DataType Declaration Start*************************************/
+// Streaming SHA-256 context
+typedef struct
+{
+    uint32_t State[8];                      // Intermediate hash value
+    uint64_t TotalLength;                   // Number of bytes hashed so far
+    uint8_t  Block[SHA256_BLOCK_SIZE];      // Partially filled message block
+    uint32_t BlockLength;                   // Number of bytes held in Block
+} SHA256_context;
+/**************************************SHA-256 DataType Declaration End**************************************/
+
+/*************************************SHA-256 Function Declaration Start*************************************/
+void SHA256_vInit(SHA256_context *Context);                                          // Start a new hash
+void SHA256_vUpdate(SHA256_context *Context, const uint8_t *Data, uint32_t Length);  // Hash the next chunk of data
+void SHA256_vFinal(SHA256_context *Context, uint8_t *Digest);                        // Pad and output the digest
+/**************************************SHA-256 Function Declaration End**************************************/
+
+#endif
@@ -0,0 +1,308 @@
+#include"SpiLink.h"
+#include<string.h>
+
+SPI_HandleTypeDef hspi2;
+static DMA_HandleTypeDef Global_stDmaRx;
+static DMA_HandleTypeDef Global_stDmaTx;
+
+// Buffers of the armed window: the host clocks the reply out of the TX buffer while its frame fills the RX buffer
+static uint8 Global_u8arrSpiRx[SPI_TRANSFER_SIZE];
+static uint8 Global_u8arrSpiTx[SPI_TRANSFER_SIZE];
+
+static volatile uint8 Global_u8FramePending = 0;       // A complete frame is in the RX buffer, set by the NSS interrupt
+static volatile uint8 Global_u8ReplyArmed = 0;         // The TX buffer holds a reply the host has not clocked out yet
+
+/**
+ * @brief  Arms a window over the whole buffers and tells the host it may clock.
+ * @retval None
+ */
+static void SpiLink_vArm(void)
+{
+    HAL_SPI_TransmitReceive_DMA(SPI_PORT, Global_u8arrSpiTx, Global_u8arrSpiRx, SPI_TRANSFER_SIZE);
+    HAL_GPIO_WritePin(SPI_READY_PORT, SPI_READY_PIN, GPIO_PIN_SET);
+}
+
+/**
+ * @brief  Ends the armed window. The peripheral is reset as well, so a byte the TX DMA already loaded
+ *         into the data register is not shifted out at the start of the next window.
+ * @retval None
+ */
+static void SpiLink_vDisarm(void)
+{
+    HAL_GPIO_WritePin(SPI_READY_PORT, SPI_READY_PIN, GPIO_PIN_RESET);
+    HAL_SPI_Abort(SPI_PORT);
+    __HAL_RCC_SPI2_FORCE_RESET();
+    __HAL_RCC_SPI2_RELEASE_RESET();
+    HAL_SPI_Init(SPI_PORT);
+}
+
+/**
+ * @brief  Starts SPI2 as a mode 0 slave with hardware NSS and arms the first window with an empty reply.
+ *         CubeMX leaves the pins alone so they stay free while the link is disabled, the peripheral is set up here.
+ * @retval None
+ */
+void SpiLink_vInit(void)
+{
+    hspi2.Instance = SPI2;
+    hspi2.Init.Mode = SPI_MODE_SLAVE;
+    hspi2.Init.Direction = SPI_DIRECTION_2LINES;
+    hspi2.Init.DataSize = SPI_DATASIZE_8BIT;
+    hspi2.Init.CLKPolarity = SPI_POLARITY_LOW;
+    hspi2.Init.CLKPhase = SPI_PHASE_1EDGE;
+    hspi2.Init.NSS = SPI_NSS_HARD_INPUT;
+    hspi2.Init.FirstBit = SPI_FIRSTBIT_MSB;
+    hspi2.Init.TIMode = SPI_TIMODE_DISABLE;
+    hspi2.Init.CRCCalculation = SPI_CRCCALCULATION_DISABLE;
+    hspi2.Init.CRCPolynomial = 10;
+    if (HAL_SPI_Init(SPI_PORT) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    Global_u8FramePending = 0;
+    Global_u8ReplyArmed = 0;
+    memset(Global_u8arrSpiTx, 0, sizeof(Global_u8arrSpiTx));
+    SpiLink_vArm();
+}
+
+/**
+ * @brief  Stops SPI2 and releases its pins, DMA channels and interrupts before leaving the bootloader.
+ * @retval None
+ */
+void SpiLink_vDeInit(void)
+{
+    HAL_GPIO_WritePin(SPI_READY_PORT, SPI_READY_PIN, GPIO_PIN_RESET);
+    HAL_SPI_Abort(SPI_PORT);
+    HAL_SPI_DeInit(SPI_PORT);
+}
+
+/**
+ * @brief  Transport adapter: non-zero once the host ended a window carrying a frame.
+ * @retval uint8
+ */
+static uint8 SpiLink_u8Receiving(void)
+{
+    return Global_u8FramePending;
+}
+
+/**
+ * @brief  Transport adapter: takes the frame of the last window. It stays valid until the reply is armed,
+ *         the host only clocks the next window after that.
+ * @retval Pointer to the length byte of the frame, NULL if no frame is pending.
+ */
+static uint8* SpiLink_pu8ReceiveFrame(void)
+{
+    if (!Global_u8FramePending)
+    {
+        return NULL;
+    }
+    Global_u8FramePending = 0;
+
+    return Global_u8arrSpiRx;
+}
+
+/**
+ * @brief  Transport adapter: nothing to drop, a window is only reported once the host ended it.
+ * @retval None
+ */
+static void SpiLink_vDiscard(void)
+{
+}
+
+/**
+ * @brief  Transport adapter: waits until the host clocked out the reply armed before, so a second send
+ *         (the raw applet result behind the reply) does not overwrite it.
+ * @retval None
+ */
+static void SpiLink_vFlush(void)
+{
+    uint32 Local_u32Start = HAL_GetTick();
+
+    while (Global_u8ReplyArmed && ((HAL_GetTick() - Local_u32Start) <= SPI_TX_TIMEOUT))
+    {
+    }
+}
+
+/**
+ * @brief  Transport adapter: gathers the segments into the TX buffer and arms the window that returns them.
+ * @retval None
+ */
+static void SpiLink_vSendGather(const TRANSPORT_segment* Segments, uint8 Count)
+{
+    uint16 Local_u16Length = 0;
+
+    // Step 1: Wait for the previous reply, then take READY low and let a window already started end
+    SpiLink_vFlush();
+    HAL_GPIO_WritePin(SPI_READY_PORT, SPI_READY_PIN, GPIO_PIN_RESET);
+    while (HAL_GPIO_ReadPin(SPI_NSS_PORT, SPI_NSS_PIN) == GPIO_PIN_RESET)
+    {
+    }
+    SpiLink_vDisarm();
+
+    // Step 2: Load the reply, zero padded, and arm the window that returns it
+    Local_u16Length = Transport_u16Gather(Global_u8arrSpiTx, sizeof(Global_u8arrSpiTx), Segments, Count);
+    memset(&Global_u8arrSpiTx[Local_u16Length], 0, sizeof(Global_u8arrSpiTx) - Local_u16Length);
+    Global_u8ReplyArmed = 1;
+    SpiLink_vArm();
+}
+
+/**
+ * @brief  Transport adapter: one block, sent as a single segment.
+ * @retval None
+ */
+static void SpiLink_vSend(const uint8* Data, uint16 Length)
+{
+    TRANSPORT_segment Local_stSegment = { Data, Length };
+
+    SpiLink_vSendGather(&Local_stSegment, 1u);
+}
+
+/**
+ * @brief  Transport adapter: SCK is generated by the host, this is the fastest clock the slave follows.
+ * @retval uint32: bit/s
+ */
+static uint32 SpiLink_u32LinkSpeed(void)
+{
+    return SPI_LINK_SPEED;
+}
+
+const TRANSPORT_backend SpiLink_stTransport =
+{
+    SpiLink_u8Receiving,
+    SpiLink_pu8ReceiveFrame,
+    SpiLink_vDiscard,
+    SpiLink_vSend,
+    SpiLink_vSendGather,
+    SpiLink_vFlush,
+    SpiLink_u32LinkSpeed,
+};
+
+/**
+ * @brief  EXTI callback of the HAL GPIO driver, NSS going high ends a window.
+ *
+ * The number of bytes the host clocked is read from the RX DMA counter. Clocking at least one byte
+ * consumes the armed reply. A window whose first byte is a length byte and that holds the whole frame
+ * carries a frame: READY stays low until the reply is armed. Any other window (the host only read the
+ * reply, clocking zeros) is armed again at once with an empty reply.
+ * @param  GPIO_Pin: Pin of the EXTI line.
+ * @retval None
+ */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    uint16 Local_u16Clocked = 0;
+
+    if (GPIO_Pin != SPI_NSS_PIN)
+    {
+        return;
+    }
+
+    Local_u16Clocked = (uint16)(SPI_TRANSFER_SIZE - __HAL_DMA_GET_COUNTER(hspi2.hdmarx));
+    SpiLink_vDisarm();
+
+    if (Local_u16Clocked == 0u)
+    {
+        SpiLink_vArm();
+        return;
+    }
+    Global_u8ReplyArmed = 0;
+
+    if ((Global_u8arrSpiRx[0] != 0u) && (Local_u16Clocked >= ((uint16)Global_u8arrSpiRx[0] + 1u)))
+    {
+        Global_u8FramePending = 1;
+    }
+    else
+    {
+        memset(Global_u8arrSpiTx, 0, sizeof(Global_u8arrSpiTx));
+        SpiLink_vArm();
+    }
+}
+
+/**
+ * @brief  SPI2 MSP setup: clock, pins, the READY output, the NSS EXTI line and DMA1 channels 4 (RX) and 5 (TX).
+ * @retval None
+ */
+void HAL_SPI_MspInit(SPI_HandleTypeDef* spiHandle)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    if (spiHandle->Instance == SPI2)
+    {
+        __HAL_RCC_SPI2_CLK_ENABLE();
+        __HAL_RCC_GPIOB_CLK_ENABLE();
+
+        // NSS is read by the SPI and raises the EXTI line that ends a window
+        GPIO_InitStruct.Pin = SPI_NSS_PIN;
+        GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+        GPIO_InitStruct.Pull = GPIO_PULLUP;
+        HAL_GPIO_Init(SPI_NSS_PORT, &GPIO_InitStruct);
+
+        GPIO_InitStruct.Pin = GPIO_PIN_13 | GPIO_PIN_15;
+        GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+        GPIO_InitStruct.Pull = GPIO_NOPULL;
+        HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+        GPIO_InitStruct.Pin = GPIO_PIN_14;
+        GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+        GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+        HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+        HAL_GPIO_WritePin(SPI_READY_PORT, SPI_READY_PIN, GPIO_PIN_RESET);
+        GPIO_InitStruct.Pin = SPI_READY_PIN;
+        GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+        GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+        HAL_GPIO_Init(SPI_READY_PORT, &GPIO_InitStruct);
+
+        Global_stDmaRx.Instance = DMA1_Channel4;
+        Global_stDmaRx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+        Global_stDmaRx.Init.PeriphInc = DMA_PINC_DISABLE;
+        Global_stDmaRx.Init.MemInc = DMA_MINC_ENABLE;
+        Global_stDmaRx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        Global_stDmaRx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+        Global_stDmaRx.Init.Mode = DMA_NORMAL;
+        Global_stDmaRx.Init.Priority = DMA_PRIORITY_VERY_HIGH;
+        if (HAL_DMA_Init(&Global_stDmaRx) != HAL_OK)
+        {
+            Error_Handler();
+        }
+        __HAL_LINKDMA(spiHandle, hdmarx, Global_stDmaRx);
+
+        Global_stDmaTx.Instance = DMA1_Channel5;
+        Global_stDmaTx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+        Global_stDmaTx.Init.PeriphInc = DMA_PINC_DISABLE;
+        Global_stDmaTx.Init.MemInc = DMA_MINC_ENABLE;
+        Global_stDmaTx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        Global_stDmaTx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+        Global_stDmaTx.Init.Mode = DMA_NORMAL;
+        Global_stDmaTx.Init.Priority = DMA_PRIORITY_HIGH;
+        if (HAL_DMA_Init(&Global_stDmaTx) != HAL_OK)
+        {
+            Error_Handler();
+        }
+        __HAL_LINKDMA(spiHandle, hdmatx, Global_stDmaTx);
+
+        HAL_NVIC_SetPriority(DMA1_Channel4_IRQn, 1, 0);
+        HAL_NVIC_EnableIRQ(DMA1_Channel4_IRQn);
+        HAL_NVIC_SetPriority(DMA1_Channel5_IRQn, 1, 0);
+        HAL_NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+        HAL_NVIC_SetPriority(EXTI15_10_IRQn, 1, 0);
+        HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+    }
+}
+
+/**
+ * @brief  SPI2 MSP teardown.
+ * @retval None
+ */
+void HAL_SPI_MspDeInit(SPI_HandleTypeDef* spiHandle)
+{
+    if (spiHandle->Instance == SPI2)
+    {
+        __HAL_RCC_SPI2_CLK_DISABLE();
+        HAL_NVIC_DisableIRQ(EXTI15_10_IRQn);
+        HAL_NVIC_DisableIRQ(DMA1_Channel4_IRQn);
+        HAL_NVIC_DisableIRQ(DMA1_Channel5_IRQn);
+        HAL_DMA_DeInit(spiHandle->hdmarx);
+        HAL_DMA_DeInit(spiHandle->hdmatx);
+        HAL_GPIO_DeInit(GPIOB, SPI_NSS_PIN | GPIO_PIN_13 | GPIO_PIN_14 | GPIO_PIN_15 | SPI_READY_PIN);
+    }
+}
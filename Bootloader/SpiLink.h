@@ -0,0 +1,33 @@
+#ifndef SPILINK_H
+#define SPILINK_H
+
+/********************************************Library Include Start********************************************/
+#include "STD_TYPES.h"   // Standard type definitions
+#include "main.h"        // HAL SPI driver
+#include "Transport.h"   // Transport backend interface
+/********************************************Library Include End********************************************/
+
+/**************************************SpiLink Macros Declaration Start**************************************/
+#define SPI_PORT                               &hspi2       // SPI slave handle
+#define SPI_TRANSFER_SIZE                      TRANSPORT_MAX_GATHER // Bytes armed per window, a full reply or frame
+#define SPI_TX_TIMEOUT                         1000u        // ms to wait for the host to read the previous reply
+#define SPI_LINK_SPEED                         18000000u    // Fastest SCK the slave follows (PCLK1 / 2), set by the host
+
+// SPI2 pins: PB12 NSS (also the EXTI line that ends a window), PB13 SCK, PB14 MISO, PB15 MOSI
+#define SPI_NSS_PORT                           GPIOB
+#define SPI_NSS_PIN                            GPIO_PIN_12
+#define SPI_READY_PORT                         GPIOB        // High while a window is armed, low while busy
+#define SPI_READY_PIN                          GPIO_PIN_1
+/***************************************SpiLink Macros Declaration End***************************************/
+
+/*************************************SpiLink Variable Declaration Start*************************************/
+extern SPI_HandleTypeDef hspi2;
+extern const TRANSPORT_backend SpiLink_stTransport;            // SPI slave windows as a transport backend
+/**************************************SpiLink Variable Declaration End**************************************/
+
+/*************************************SpiLink Function Declaration Start*************************************/
+void SpiLink_vInit(void);                                       // Start SPI2 as slave and arm the first window
+void SpiLink_vDeInit(void);                                     // Stop SPI2 before leaving the bootloader
+/**************************************SpiLink Function Declaration End**************************************/
+
+#endif
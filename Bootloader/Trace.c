@@ -0,0 +1,80 @@
+#include"Trace.h"
+#include<stddef.h>
+
+// Start timestamp and accumulated cycles of every phase for the frame being handled
+static uint32 Global_u32arrPhaseStart[TRACE_PHASE_COUNT];
+static uint32 Global_u32arrFrameCycles[TRACE_PHASE_COUNT];
+static uint8 Global_u8PhaseMask = 0;        // Bit per phase that ran during the frame
+
+/**
+ * @brief  Enables the DWT cycle counter, it counts core clock cycles and wraps every 2^32 cycles.
+ * @retval None
+ */
+void Trace_vInit(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief  Timestamps the start of a phase.
+ * @param  Copy_enPhase: Phase that starts.
+ * @retval None
+ */
+void Trace_vStart(TRACE_phase Copy_enPhase)
+{
+    Global_u32arrPhaseStart[Copy_enPhase] = TRACE_CYCLES();
+}
+
+/**
+ * @brief  Adds the cycles since Trace_vStart() to the phase total of the current frame.
+ *         Unsigned subtraction keeps the result right across one counter wrap.
+ * @param  Copy_enPhase: Phase that ends.
+ * @retval None
+ */
+void Trace_vStop(TRACE_phase Copy_enPhase)
+{
+    Global_u32arrFrameCycles[Copy_enPhase] += TRACE_CYCLES() - Global_u32arrPhaseStart[Copy_enPhase];
+    Global_u8PhaseMask |= (uint8)(1u << Copy_enPhase);
+}
+
+/**
+ * @brief  Adds the phases of the finished frame to the histograms of its command and starts a new frame.
+ * @param  Copy_pstStats: Statistics of the command the frame carried, NULL for rejected frames.
+ * @retval None
+ */
+void Trace_vEndFrame(TRACE_command_stats* Copy_pstStats)
+{
+    uint8 Local_u8Phase = 0;
+
+    for (Local_u8Phase = 0; Local_u8Phase < TRACE_PHASE_COUNT; Local_u8Phase++)
+    {
+        uint32 Local_u32Cycles = Global_u32arrFrameCycles[Local_u8Phase];
+
+        if ((NULL != Copy_pstStats) && (0u != (Global_u8PhaseMask & (1u << Local_u8Phase))))
+        {
+            TRACE_phase_stats* Local_pstPhase = &Copy_pstStats->Phases[Local_u8Phase];
+            uint8 Local_u8Bucket = 0;
+
+            // Bucket 0 is below 2^TRACE_FIRST_BUCKET_SHIFT cycles, then one bucket per TRACE_BUCKET_SHIFT_STEP bits
+            if (Local_u32Cycles >= (1uL << TRACE_FIRST_BUCKET_SHIFT))
+            {
+                Local_u8Bucket = (uint8)(((31u - __CLZ(Local_u32Cycles) - TRACE_FIRST_BUCKET_SHIFT) / TRACE_BUCKET_SHIFT_STEP) + 1u);
+                if (Local_u8Bucket >= TRACE_BUCKET_COUNT)
+                {
+                    Local_u8Bucket = TRACE_BUCKET_COUNT - 1u;
+                }
+            }
+            if (Local_pstPhase->Buckets[Local_u8Bucket] != 0xFFFFu)
+            {
+                Local_pstPhase->Buckets[Local_u8Bucket]++;
+            }
+
+            Local_pstPhase->TotalCycles = (Local_pstPhase->TotalCycles > (0xFFFFFFFFu - Local_u32Cycles)) ?
+                                          0xFFFFFFFFu : (Local_pstPhase->TotalCycles + Local_u32Cycles);
+        }
+        Global_u32arrFrameCycles[Local_u8Phase] = 0;
+    }
+    Global_u8PhaseMask = 0;
+}
@@ -0,0 +1,51 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/********************************************Library Include Start********************************************/
+#include "STD_TYPES.h"   // Standard type definitions
+#include "stm32f1xx.h"   // DWT and CoreDebug register definitions
+/********************************************Library Include End********************************************/
+
+/***************************************Trace Macros Declaration Start***************************************/
+#define TRACE_BUCKET_COUNT                     6u           // Histogram buckets per phase
+#define TRACE_FIRST_BUCKET_SHIFT               10u          // Bucket 0 holds samples below 2^10 cycles
+#define TRACE_BUCKET_SHIFT_STEP                3u           // Each further bucket is 8 times wider
+
+// Cycle source, a host build defines it before including this header (e.g. from clock_gettime)
+#ifndef TRACE_CYCLES
+#define TRACE_CYCLES()                         (DWT->CYCCNT)
+#endif
+/****************************************Trace Macros Declaration End****************************************/
+
+/**************************************Trace DataType Declaration Start**************************************/
+typedef enum
+{
+    TRACE_PHASE_RECEIVE = 0,    // First byte of the frame until the whole frame is in the ring
+    TRACE_PHASE_CRC,            // Frame CRC check
+    TRACE_PHASE_ERASE,          // Flash page erase
+    TRACE_PHASE_PROGRAM,        // Flash programming
+    TRACE_PHASE_REPLY,          // ACK, NACK and reply transmission
+    TRACE_PHASE_COUNT
+} TRACE_phase;
+
+// Time spent in one phase per frame, summed over every time the phase ran while the frame was handled
+typedef struct
+{
+    uint32 TotalCycles;                         // Saturates at 0xFFFFFFFF
+    uint16 Buckets[TRACE_BUCKET_COUNT];         // Frames per cycle range, see TRACE_FIRST_BUCKET_SHIFT
+} TRACE_phase_stats;
+
+typedef struct
+{
+    TRACE_phase_stats Phases[TRACE_PHASE_COUNT];
+} TRACE_command_stats;
+/***************************************Trace DataType Declaration End***************************************/
+
+/**************************************Trace Function Declaration Start**************************************/
+void Trace_vInit(void);                                     // Start the DWT cycle counter
+void Trace_vStart(TRACE_phase Copy_enPhase);                // Timestamp the start of a phase
+void Trace_vStop(TRACE_phase Copy_enPhase);                 // Add the elapsed cycles to the current frame
+void Trace_vEndFrame(TRACE_command_stats* Copy_pstStats);   // Fold the frame into a command's histograms (NULL discards it)
+/***************************************Trace Function Declaration End***************************************/
+
+#endif
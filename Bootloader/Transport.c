@@ -0,0 +1,47 @@
+#include"Transport.h"
+#include<string.h>
+
+// Staging buffer of the links that send blocking and need the reply in one piece (USB, CAN)
+static uint8 Global_u8arrStage[TRANSPORT_MAX_GATHER];
+
+/**
+ * @brief  Copies segments back to back into a buffer, bytes beyond Size are dropped.
+ * @param  Buffer: Destination buffer.
+ * @param  Size: Size of the destination buffer.
+ * @param  Segments: Blocks to copy, in order.
+ * @param  Count: Number of blocks.
+ * @retval uint16: Number of bytes copied.
+ */
+uint16 Transport_u16Gather(uint8* Buffer, uint16 Size, const TRANSPORT_segment* Segments, uint8 Count)
+{
+    uint16 Local_u16Length = 0;
+    uint16 Local_u16Copy = 0;
+    uint8 Local_u8Index = 0;
+
+    for (Local_u8Index = 0; Local_u8Index < Count; Local_u8Index++)
+    {
+        Local_u16Copy = Segments[Local_u8Index].Length;
+        if (Local_u16Copy > (Size - Local_u16Length))
+        {
+            Local_u16Copy = Size - Local_u16Length;
+        }
+        memcpy(&Buffer[Local_u16Length], Segments[Local_u8Index].Data, Local_u16Copy);
+        Local_u16Length += Local_u16Copy;
+    }
+
+    return Local_u16Length;
+}
+
+/**
+ * @brief  Gather-send for links whose SendFrame is blocking: the segments are staged once and sent
+ *         as a single transfer, so the host sees one bulk transfer or one ISO-TP message.
+ * @param  Segments: Blocks to send, in order.
+ * @param  Count: Number of blocks.
+ * @param  SendFrame: Blocking send function of the link.
+ * @retval None
+ */
+void Transport_vSendGatherCopy(const TRANSPORT_segment* Segments, uint8 Count,
+                               void (*SendFrame)(const uint8* Data, uint16 Length))
+{
+    SendFrame(Global_u8arrStage, Transport_u16Gather(Global_u8arrStage, sizeof(Global_u8arrStage), Segments, Count));
+}
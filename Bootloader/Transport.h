@@ -0,0 +1,44 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+/********************************************Library Include Start********************************************/
+#include "STD_TYPES.h"   // Standard type definitions
+/********************************************Library Include End********************************************/
+
+/*************************************Transport Macros Declaration Start*************************************/
+#define TRANSPORT_MAX_GATHER                   261u         // Largest gathered transmission: ACK header, a 255-byte payload and the reply CRC
+/**************************************Transport Macros Declaration End**************************************/
+
+/************************************Transport DataType Declaration Start************************************/
+// One block of a gathered transmission
+typedef struct
+{
+    const uint8* Data;
+    uint16 Length;
+} TRANSPORT_segment;
+
+/*
+ * Link between the host and the command engine.
+ * Each link module (UartLink, UsbLink, CanLink) exports one or more backends. The engine polls
+ * Receiving() on every enabled backend, takes the frame from the first one that starts receiving
+ * and sends the reply on the same backend.
+ */
+typedef struct
+{
+    uint8  (*Receiving)(void);                                      // Non-zero once bytes of a frame arrived
+    uint8* (*ReceiveFrame)(void);                                   // Complete frame (length byte first), NULL while incomplete
+    void   (*Discard)(void);                                        // Drop the bytes of an incomplete frame
+    void   (*SendFrame)(const uint8* Data, uint16 Length);          // Send one block of bytes
+    void   (*SendGather)(const TRANSPORT_segment* Segments, uint8 Count); // Send several blocks as one transmission
+    void   (*Flush)(void);                                          // Wait until everything sent has left the link
+    uint32 (*LinkSpeed)(void);                                      // Nominal link speed in bit/s
+} TRANSPORT_backend;
+/*************************************Transport DataType Declaration End*************************************/
+
+/************************************Transport Function Declaration Start************************************/
+uint16 Transport_u16Gather(uint8* Buffer, uint16 Size, const TRANSPORT_segment* Segments, uint8 Count); // Copy segments back to back
+void Transport_vSendGatherCopy(const TRANSPORT_segment* Segments, uint8 Count,
+                               void (*SendFrame)(const uint8* Data, uint16 Length)); // Gather into a staging buffer, send once
+/*************************************Transport Function Declaration End*************************************/
+
+#endif
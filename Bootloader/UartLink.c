@@ -0,0 +1,371 @@
+#include"UartLink.h"
+#include<string.h>
+
+// DMA receive ring, the UART_RX_MIRROR_SIZE bytes after the ring mirror its start so a frame that wraps
+// around can still be parsed in place as one contiguous block
+static uint8 Global_u8arrRxRing[UART_RX_RING_SIZE + UART_RX_MIRROR_SIZE];
+static uint16 Global_u16RxTail = 0;
+
+// Source of the DMA transmission, stays untouched until the transfer completed
+static uint8 Global_u8arrTxBuffer[TRANSPORT_MAX_GATHER];
+static uint32 Global_u32TxTimeout = 0;            // ms allowed for the transfer in progress
+
+// RS-485 node address, compared by the USART with the address character in front of each frame
+static uint8 Global_u8NodeId = 0;
+
+/**
+ * @brief  Starts the circular DMA reception, frames are then taken straight out of the ring.
+ * @retval None
+ */
+void UartLink_vInit(void)
+{
+    Global_u16RxTail = 0;
+    HAL_UART_Receive_DMA(UART_PORT, Global_u8arrRxRing, UART_RX_RING_SIZE);
+}
+
+/**
+ * @brief  Stops USART3 and its DMA channels before leaving the bootloader. The circular reception would
+ *         otherwise keep writing incoming bytes into the ring, which is the application's RAM by then,
+ *         and raise DMA interrupts through the application's vector table.
+ * @retval None
+ */
+void UartLink_vDeInit(void)
+{
+    // Step 1: Stop both DMA channels and keep their interrupts from reaching the application
+    HAL_UART_DMAStop(UART_PORT);
+    HAL_NVIC_DisableIRQ(DMA1_Channel3_IRQn);
+    HAL_NVIC_DisableIRQ(DMA1_Channel2_IRQn);
+    HAL_NVIC_ClearPendingIRQ(DMA1_Channel3_IRQn);
+    HAL_NVIC_ClearPendingIRQ(DMA1_Channel2_IRQn);
+
+    // Step 2: Release the USART, its pins and DMA channels, and the RS-485 driver enable
+    HAL_UART_DeInit(UART_PORT);
+    HAL_GPIO_DeInit(RS485_DE_PORT, RS485_DE_PIN);
+}
+
+/**
+ * @brief  Starts USART3 as an RS-485 node: 9-bit characters, address mark wake-up on the node ID and mute
+ *         mode, so the USART drops every character until an address character carrying this node's ID
+ *         arrives and the CPU never sees the traffic of the other nodes. It mutes again by itself when
+ *         the address character of another node arrives. The node ID is the DATA1 option byte (1..15),
+ *         or the unique device ID folded into 1..15 while DATA1 is erased or out of range.
+ * @retval None
+ */
+void UartLink_vInitRs485(void)
+{
+    GPIO_InitTypeDef Local_stGpio = {0};
+    const uint8* Local_pu8Uid = (const uint8*)RS485_UID_ADDRESS;
+    uint8 Local_u8NodeId = (uint8)HAL_FLASHEx_OBGetUserData(OB_DATA_ADDRESS_DATA1);
+    uint8 Local_u8Fold = 0;
+    uint8 Local_u8Index = 0;
+
+    // Step 1: Pick the node ID
+    if ((Local_u8NodeId == 0u) || (Local_u8NodeId > RS485_MAX_NODE_ID))
+    {
+        for (Local_u8Index = 0; Local_u8Index < RS485_UID_SIZE; Local_u8Index++)
+        {
+            Local_u8Fold ^= Local_pu8Uid[Local_u8Index];
+        }
+        Local_u8NodeId = (uint8)((Local_u8Fold % RS485_MAX_NODE_ID) + 1u);
+    }
+    Global_u8NodeId = Local_u8NodeId;
+
+    // Step 2: Keep the transceiver in receive mode
+    HAL_GPIO_WritePin(RS485_DE_PORT, RS485_DE_PIN, GPIO_PIN_RESET);
+    Local_stGpio.Pin = RS485_DE_PIN;
+    Local_stGpio.Mode = GPIO_MODE_OUTPUT_PP;
+    Local_stGpio.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(RS485_DE_PORT, &Local_stGpio);
+
+    // Step 3: 9-bit characters, the 9th bit set marks an address character
+    (UART_PORT)->Init.WordLength = UART_WORDLENGTH_9B;
+    HAL_MultiProcessor_Init(UART_PORT, Global_u8NodeId, UART_WAKEUPMETHOD_ADDRESSMARK);
+
+    // Step 4: The DMA keeps only the 8 low bits, the ring holds the address byte in front of each frame
+    UartLink_vInit();
+    HAL_MultiProcessor_EnterMuteMode(UART_PORT);
+}
+
+/**
+ * @brief  Returns the RS-485 node ID, valid once UartLink_vInitRs485 ran.
+ * @retval uint8
+ */
+uint8 UartLink_u8GetNodeId(void)
+{
+    return Global_u8NodeId;
+}
+
+/**
+ * @brief  Returns the number of received bytes that were not consumed yet.
+ *
+ * The DMA write position is derived from the remaining transfer count of the circular channel.
+ * @retval Number of pending bytes in the receive ring.
+ */
+static uint16 UartLink_u16Available(void)
+{
+    uint16 Local_u16Head = (uint16)(UART_RX_RING_SIZE - __HAL_DMA_GET_COUNTER((UART_PORT)->hdmarx));
+
+    return (uint16)((Local_u16Head - Global_u16RxTail) & (UART_RX_RING_SIZE - 1u));
+}
+
+/**
+ * @brief  Returns non-zero once the length byte of a frame is in the ring.
+ * @retval uint8
+ */
+static uint8 UartLink_u8Receiving(void)
+{
+    return (uint8)(UartLink_u16Available() >= 1u);
+}
+
+/**
+ * @brief  Returns a pointer to the next frame inside the receive ring once it is complete.
+ *
+ * The frame is not copied. When it wraps around the end of the ring, only the wrapped bytes are
+ * copied into the mirror area behind the ring so the frame is contiguous. The frame stays valid
+ * until the host sends the next one, as the host waits for the reply before sending again.
+ * @retval Pointer to the length byte of the frame, NULL while the frame is incomplete.
+ */
+static uint8* UartLink_pu8ReceiveFrame(void)
+{
+    uint8* Local_pu8Frame = &Global_u8arrRxRing[Global_u16RxTail];
+    uint16 Local_u16Available = UartLink_u16Available();
+    uint16 Local_u16FrameLength = 0;
+
+    // Step 1: Wait for the length byte and the rest of the frame
+    if (Local_u16Available < 1u)
+    {
+        return NULL;
+    }
+    Local_u16FrameLength = (uint16)Local_pu8Frame[0] + 1u;
+    if (Local_u16Available < Local_u16FrameLength)
+    {
+        return NULL;
+    }
+
+    // Step 2: Make a wrapped frame contiguous by mirroring the start of the ring
+    if ((Global_u16RxTail + Local_u16FrameLength) > UART_RX_RING_SIZE)
+    {
+        memcpy(&Global_u8arrRxRing[UART_RX_RING_SIZE], Global_u8arrRxRing,
+               (Global_u16RxTail + Local_u16FrameLength) - UART_RX_RING_SIZE);
+    }
+
+    // Step 3: Consume the frame
+    Global_u16RxTail = (uint16)((Global_u16RxTail + Local_u16FrameLength) & (UART_RX_RING_SIZE - 1u));
+
+    return Local_pu8Frame;
+}
+
+/**
+ * @brief  Drops everything received so far, after a frame stayed incomplete for FRAME_TIMEOUT.
+ *         The first byte after the discarded ones is taken as the length byte of the next frame.
+ * @retval None
+ */
+static void UartLink_vDiscard(void)
+{
+    Global_u16RxTail = (uint16)((Global_u16RxTail + UartLink_u16Available()) & (UART_RX_RING_SIZE - 1u));
+}
+
+/**
+ * @brief  RS-485 variant: every frame is preceded by the address character that woke the USART, it is
+ *         dropped once the frame behind it is complete.
+ * @retval Pointer to the length byte of the frame, NULL while the frame is incomplete.
+ */
+static uint8* UartLink_pu8Rs485ReceiveFrame(void)
+{
+    uint16 Local_u16Available = UartLink_u16Available();
+    uint16 Local_u16FrameLength = 0;
+
+    // Step 1: Wait for the address byte, the length byte and the rest of the frame
+    if (Local_u16Available < 2u)
+    {
+        return NULL;
+    }
+    Local_u16FrameLength = (uint16)Global_u8arrRxRing[(Global_u16RxTail + 1u) & (UART_RX_RING_SIZE - 1u)] + 1u;
+    if (Local_u16Available < (Local_u16FrameLength + 1u))
+    {
+        return NULL;
+    }
+
+    // Step 2: Drop the address byte and take the frame
+    Global_u16RxTail = (uint16)((Global_u16RxTail + 1u) & (UART_RX_RING_SIZE - 1u));
+
+    return UartLink_pu8ReceiveFrame();
+}
+
+/**
+ * @brief  Returns the configured baud rate.
+ * @retval uint32: bit/s
+ */
+static uint32 UartLink_u32LinkSpeed(void)
+{
+    return (UART_PORT)->Init.BaudRate;
+}
+
+/**
+ * @brief  Writes bytes to the data register as soon as TXE allows, through the LL driver instead of
+ *         HAL_UART_Transmit: the data path needs no handle locking, state machine or timeout bookkeeping.
+ * @retval None
+ */
+static void UartLink_vPut(const uint8* Data, uint16 Length)
+{
+    USART_TypeDef* Local_pstUart = (UART_PORT)->Instance;
+    uint16 Local_u16Counter = 0;
+
+    for (Local_u16Counter = 0; Local_u16Counter < Length; Local_u16Counter++)
+    {
+        while (!LL_USART_IsActiveFlag_TXE(Local_pstUart));
+        LL_USART_TransmitData8(Local_pstUart, Data[Local_u16Counter]);
+    }
+}
+
+/**
+ * @brief  Waits for the last byte to leave the shift register before the caller jumps or resets.
+ * @retval None
+ */
+static void UartLink_vPollingFlush(void)
+{
+    while (!LL_USART_IsActiveFlag_TC((UART_PORT)->Instance));
+}
+
+/**
+ * @brief  Polling send of one block.
+ * @retval None
+ */
+static void UartLink_vPollingSend(const uint8* Data, uint16 Length)
+{
+    UartLink_vPut(Data, Length);
+    UartLink_vPollingFlush();
+}
+
+/**
+ * @brief  Polling gather-send, the segments go out back to back without being copied.
+ * @retval None
+ */
+static void UartLink_vPollingGather(const TRANSPORT_segment* Segments, uint8 Count)
+{
+    uint8 Local_u8Index = 0;
+
+    for (Local_u8Index = 0; Local_u8Index < Count; Local_u8Index++)
+    {
+        UartLink_vPut(Segments[Local_u8Index].Data, Segments[Local_u8Index].Length);
+    }
+    UartLink_vPollingFlush();
+}
+
+/**
+ * @brief  Waits until the DMA transfer in progress and the last byte on the wire are done.
+ *         A transfer that takes more than twice its nominal time is given up so the channel is usable again.
+ * @retval None
+ */
+static void UartLink_vDmaFlush(void)
+{
+    DMA_HandleTypeDef* Local_pstDma = (UART_PORT)->hdmatx;
+
+    if (HAL_DMA_GetState(Local_pstDma) == HAL_DMA_STATE_BUSY)
+    {
+        HAL_DMA_PollForTransfer(Local_pstDma, HAL_DMA_FULL_TRANSFER, Global_u32TxTimeout);
+    }
+    UartLink_vPollingFlush();
+}
+
+/**
+ * @brief  Starts the DMA transmission of the first Length bytes of the TX buffer and returns.
+ * @retval None
+ */
+static void UartLink_vDmaStart(uint16 Length)
+{
+    USART_TypeDef* Local_pstUart = (UART_PORT)->Instance;
+
+    // 10 bits per byte, twice the nominal time plus one tick of margin
+    Global_u32TxTimeout = ((uint32)Length * 20000uL / UartLink_u32LinkSpeed()) + 2u;
+
+    // DMA writes to DR do not clear TC, so it is cleared here and set again once the last byte left
+    LL_USART_ClearFlag_TC(Local_pstUart);
+    HAL_DMA_Start((UART_PORT)->hdmatx, (uint32)Global_u8arrTxBuffer, (uint32)&Local_pstUart->DR, Length);
+    LL_USART_EnableDMAReq_TX(Local_pstUart);
+}
+
+/**
+ * @brief  DMA send of one block, the bytes are copied so the caller may reuse its buffer at once.
+ *         Blocks larger than the TX buffer (applet output) go out in buffer-sized pieces.
+ * @retval None
+ */
+static void UartLink_vDmaSend(const uint8* Data, uint16 Length)
+{
+    uint16 Local_u16Chunk = 0;
+
+    while (Length > 0u)
+    {
+        Local_u16Chunk = (Length > sizeof(Global_u8arrTxBuffer)) ? sizeof(Global_u8arrTxBuffer) : Length;
+        UartLink_vDmaFlush();
+        memcpy(Global_u8arrTxBuffer, Data, Local_u16Chunk);
+        UartLink_vDmaStart(Local_u16Chunk);
+        Data += Local_u16Chunk;
+        Length -= Local_u16Chunk;
+    }
+}
+
+/**
+ * @brief  DMA gather-send, the segments are gathered straight into the DMA source buffer.
+ * @retval None
+ */
+static void UartLink_vDmaGather(const TRANSPORT_segment* Segments, uint8 Count)
+{
+    UartLink_vDmaFlush();
+    UartLink_vDmaStart(Transport_u16Gather(Global_u8arrTxBuffer, sizeof(Global_u8arrTxBuffer), Segments, Count));
+}
+
+/**
+ * @brief  RS-485 send of one block, the driver is enabled only while the node talks.
+ * @retval None
+ */
+static void UartLink_vRs485Send(const uint8* Data, uint16 Length)
+{
+    HAL_GPIO_WritePin(RS485_DE_PORT, RS485_DE_PIN, GPIO_PIN_SET);
+    UartLink_vPollingSend(Data, Length);
+    HAL_GPIO_WritePin(RS485_DE_PORT, RS485_DE_PIN, GPIO_PIN_RESET);
+}
+
+/**
+ * @brief  RS-485 gather-send, the driver is released once the last byte left the shift register.
+ * @retval None
+ */
+static void UartLink_vRs485Gather(const TRANSPORT_segment* Segments, uint8 Count)
+{
+    HAL_GPIO_WritePin(RS485_DE_PORT, RS485_DE_PIN, GPIO_PIN_SET);
+    UartLink_vPollingGather(Segments, Count);
+    HAL_GPIO_WritePin(RS485_DE_PORT, RS485_DE_PIN, GPIO_PIN_RESET);
+}
+
+const TRANSPORT_backend UartLink_stPolling =
+{
+    UartLink_u8Receiving,
+    UartLink_pu8ReceiveFrame,
+    UartLink_vDiscard,
+    UartLink_vPollingSend,
+    UartLink_vPollingGather,
+    UartLink_vPollingFlush,
+    UartLink_u32LinkSpeed,
+};
+
+const TRANSPORT_backend UartLink_stDma =
+{
+    UartLink_u8Receiving,
+    UartLink_pu8ReceiveFrame,
+    UartLink_vDiscard,
+    UartLink_vDmaSend,
+    UartLink_vDmaGather,
+    UartLink_vDmaFlush,
+    UartLink_u32LinkSpeed,
+};
+
+const TRANSPORT_backend UartLink_stRs485 =
+{
+    UartLink_u8Receiving,
+    UartLink_pu8Rs485ReceiveFrame,
+    UartLink_vDiscard,
+    UartLink_vRs485Send,
+    UartLink_vRs485Gather,
+    UartLink_vPollingFlush,
+    UartLink_u32LinkSpeed,
+};
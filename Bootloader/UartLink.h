@@ -0,0 +1,37 @@
+#ifndef UARTLINK_H
+#define UARTLINK_H
+
+/********************************************Library Include Start********************************************/
+#include "STD_TYPES.h"   // Standard type definitions
+#include "usart.h"       // USART handles
+#include "stm32f1xx_ll_usart.h" // Register-level UART transmit on the data path
+#include "Transport.h"   // Transport backend interface
+/********************************************Library Include End********************************************/
+
+/**************************************UartLink Macros Declaration Start**************************************/
+#define UART_PORT                              &huart3      // Communication port for bootloader commands
+#define UART_RX_RING_SIZE                      512u         // DMA receive ring size (power of two, at least two frames)
+#define UART_RX_MIRROR_SIZE                    256u         // Largest frame (length byte followed by up to 255 bytes)
+
+// RS-485 multi-drop, 9-bit characters with the 9th bit marking the node address in front of each frame
+#define RS485_DE_PORT                          GPIOA        // Transceiver driver enable (DE and /RE tied together)
+#define RS485_DE_PIN                           GPIO_PIN_8
+#define RS485_MAX_NODE_ID                      0x0Fu        // The USART compares the 4 low bits of the address character
+#define RS485_UID_ADDRESS                      0x1FFFF7E8u  // 96-bit unique device ID, folded into the default node ID
+#define RS485_UID_SIZE                         12u
+/***************************************UartLink Macros Declaration End***************************************/
+
+/*************************************UartLink Variable Declaration Start*************************************/
+extern const TRANSPORT_backend UartLink_stPolling;             // CPU writes every byte, returns once the last one left
+extern const TRANSPORT_backend UartLink_stDma;                 // DMA1 channel 2 sends the reply while the engine goes on
+extern const TRANSPORT_backend UartLink_stRs485;               // Addressed frames on a multi-drop bus, polling send
+/**************************************UartLink Variable Declaration End**************************************/
+
+/*************************************UartLink Function Declaration Start*************************************/
+void UartLink_vInit(void);                                      // Start the circular DMA reception
+void UartLink_vInitRs485(void);                                 // Switch to 9-bit mute mode, then start the reception
+void UartLink_vDeInit(void);                                    // Stop USART3 and its DMA before leaving the bootloader
+uint8 UartLink_u8GetNodeId(void);                               // RS-485 node address of this board
+/**************************************UartLink Function Declaration End**************************************/
+
+#endif
@@ -0,0 +1,77 @@
+#include"Updater.h"
+
+/**
+ * @brief  Replaces the bootloader with the staged image and resets the device.
+ *
+ * This function is copied into SRAM and runs with interrupts disabled, as the bootloader pages
+ * (vector table included) are erased. It is linked alone into ER_UPDATER, whose length is what gets
+ * copied. It is leaf code: no calls and no absolute addresses, all registers and constants come from
+ * Params, and it writes only through volatile pointers so the compiler does not turn a loop into a
+ * library call. Each attempt erases the destination pages, programs the image in half-words, then
+ * reads it back through the CRC unit. The device is reset once the CRC matches. After UPDATER_RETRIES
+ * failed attempts the bootloader region is broken, a reset would start it, so the updater stays in
+ * SRAM keeping the watchdog refreshed until the device is reprogrammed over SWD. The watchdog is
+ * also refreshed after every page erase and every programmed half-word.
+ * @param  Params: Pointer to the update parameters, kept in SRAM.
+ * @retval None, the function does not return.
+ */
+__attribute__((section(UPDATER_SECTION))) void Updater_vRun(const UPDATER_params *Params)
+{
+    FLASH_TypeDef* Local_pstFlash = Params->Flash;
+    uint32_t Local_u32Attempt = 0;
+    uint32_t Local_u32Offset = 0;
+    uint32_t Local_u32Crc = 0;
+
+    for (Local_u32Attempt = 0; Local_u32Attempt < UPDATER_RETRIES; Local_u32Attempt++)
+    {
+        // Step 1: Erase the destination pages
+        for (Local_u32Offset = 0; Local_u32Offset < Params->Length; Local_u32Offset += Params->PageSize)
+        {
+            Local_pstFlash->CR |= FLASH_CR_PER;
+            Local_pstFlash->AR = (uint32_t)Params->Destination + Local_u32Offset;
+            Local_pstFlash->CR |= FLASH_CR_STRT;
+            while (0u != (Local_pstFlash->SR & FLASH_SR_BSY))
+            {
+            }
+            Local_pstFlash->CR &= ~FLASH_CR_PER;
+            *Params->WatchdogKey = Params->WatchdogRefresh;
+        }
+
+        // Step 2: Program the image in half-words
+        Local_pstFlash->CR |= FLASH_CR_PG;
+        for (Local_u32Offset = 0; Local_u32Offset < ((Params->Length + 1u) / 2u); Local_u32Offset++)
+        {
+            Params->Destination[Local_u32Offset] = Params->Source[Local_u32Offset];
+            while (0u != (Local_pstFlash->SR & FLASH_SR_BSY))
+            {
+            }
+            *Params->WatchdogKey = Params->WatchdogRefresh;
+        }
+        Local_pstFlash->CR &= ~FLASH_CR_PG;
+        Local_pstFlash->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+
+        // Step 3: Read the copy back through the CRC unit, one byte per CRC word
+        Params->Crc->CR = CRC_CR_RESET;
+        for (Local_u32Offset = 0; Local_u32Offset < Params->Length; Local_u32Offset++)
+        {
+            Params->Crc->DR = ((const volatile uint8_t*)Params->Destination)[Local_u32Offset];
+        }
+        Local_u32Crc = Params->Crc->DR;
+        Params->Crc->CR = CRC_CR_RESET;
+
+        // Step 4: Reset into the new bootloader
+        if (Local_u32Crc == Params->ExpectedCrc)
+        {
+            *Params->ResetRegister = Params->ResetRequest;
+            while (1)
+            {
+            }
+        }
+    }
+
+    // Step 5: Every attempt failed, never reset into the half-written bootloader
+    while (1)
+    {
+        *Params->WatchdogKey = Params->WatchdogRefresh;
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef UPDATER_H
+#define UPDATER_H
+
+/********************************************Library Include Start********************************************/
+#include <stdint.h>      // Fixed width types
+#include "stm32f1xx.h"   // FLASH and CRC register definitions
+/********************************************Library Include End********************************************/
+
+/**************************************Updater Macros Declaration Start**************************************/
+#define UPDATER_CODE_SIZE                      0x200u       // Largest ER_UPDATER region, checked by a ScatterAssert in Bootloader.sct
+#define UPDATER_SECTION                        "BL_UPDATER" // Section of Updater_vRun, linked alone into ER_UPDATER
+#define UPDATER_RETRIES                        3u           // Copy attempts before the updater gives up and halts
+/***************************************Updater Macros Declaration End***************************************/
+
+/*************************************Updater DataType Declaration Start*************************************/
+/*
+ * Everything the updater touches is passed in, so the copied code holds no absolute addresses and
+ * calls no function in flash while the bootloader pages are being rewritten.
+ */
+typedef struct
+{
+    FLASH_TypeDef* Flash;                   // Flash interface registers (unlocked by the caller)
+    CRC_TypeDef* Crc;                       // CRC unit used for the copy check
+    volatile uint32_t* ResetRegister;       // SCB->AIRCR
+    volatile uint32_t* WatchdogKey;         // IWDG->KR, refreshed while the pages are erased and programmed
+    uint32_t WatchdogRefresh;               // Reload key written to WatchdogKey (ignored while the IWDG is stopped)
+    uint32_t ResetRequest;                  // Value written to ResetRegister to reset the device
+    const uint16_t* Source;                 // Staged image
+    volatile uint16_t* Destination;         // Start of the bootloader region
+    uint32_t Length;                        // Image length in bytes
+    uint32_t PageSize;                      // Flash page size in bytes
+    uint32_t ExpectedCrc;                   // Protocol CRC (one byte per CRC word) of the image
+} UPDATER_params;
+
+// Entry point of the copy in SRAM
+typedef void (*UPDATER_entry)(const UPDATER_params *Params);
+/**************************************Updater DataType Declaration End**************************************/
+
+/*************************************Updater Function Declaration Start*************************************/
+void Updater_vRun(const UPDATER_params *Params);    // Copy, verify and reset, must run from SRAM
+
+// Load address and length of ER_UPDATER, defined by the linker
+extern const uint32_t Load$$ER_UPDATER$$Base;
+extern const uint32_t Image$$ER_UPDATER$$Length;
+/**************************************Updater Function Declaration End**************************************/
+
+#endif
@@ -0,0 +1,463 @@
+#include"UsbLink.h"
+#include<string.h>
+
+// Standard request codes and descriptor types used by the control endpoint
+#define USB_REQ_GET_STATUS                     0x00u
+#define USB_REQ_SET_ADDRESS                    0x05u
+#define USB_REQ_GET_DESCRIPTOR                 0x06u
+#define USB_REQ_GET_CONFIGURATION              0x08u
+#define USB_REQ_SET_CONFIGURATION              0x09u
+#define USB_DESC_DEVICE                        0x01u
+#define USB_DESC_CONFIGURATION                 0x02u
+#define USB_DESC_STRING                        0x03u
+#define USB_REQ_TYPE_MASK                      0x60u        // Standard, class or vendor request
+#define USB_UID_ADDRESS                        0x1FFFF7E8u  // 96-bit unique device ID, reported as serial number
+
+static const uint8 Global_u8arrDeviceDescriptor[18] =
+{
+    18, USB_DESC_DEVICE, 0x00, 0x02,                        // USB 2.0
+    0x00, 0x00, 0x00, USB_MAX_PACKET,                       // Class defined per interface
+    (uint8)USB_VENDOR_ID, (uint8)(USB_VENDOR_ID >> 8),
+    (uint8)USB_PRODUCT_ID, (uint8)(USB_PRODUCT_ID >> 8),
+    0x00, 0x01,                                             // Device release 1.00
+    1, 2, 3,                                                // Manufacturer, product and serial number strings
+    1                                                       // One configuration
+};
+
+static const uint8 Global_u8arrConfigDescriptor[32] =
+{
+    9, USB_DESC_CONFIGURATION, 32, 0, 1, 1, 0, 0x80, 50,    // Bus powered, 100 mA
+    9, 0x04, 0, 0, 2, 0xFF, 0x00, 0x00, 0,                  // Vendor-specific interface with two endpoints
+    7, 0x05, USB_BULK_OUT_EP, 0x02, USB_MAX_PACKET, 0, 0,   // Bulk OUT
+    7, 0x05, USB_BULK_IN_EP, 0x02, USB_MAX_PACKET, 0, 0     // Bulk IN
+};
+
+// Strings 1 and 2, index 0 is the language list and index 3 the serial number
+static const char* const Global_pcarrStrings[] = { NULL, "STMicroelectronics", "STM32 CBL Bootloader" };
+
+// Bulk OUT ring, packets are received at the head and frames are read at the tail. Indices run freely.
+// The bytes between the released index and the tail hold the frame being handled and are never overwritten
+static uint8 Global_u8arrUsbRing[USB_RX_RING_SIZE + USB_RX_MIRROR_SIZE];
+static volatile uint16 Global_u16UsbHead = 0;       // Written by the bulk OUT callback only
+static volatile uint16 Global_u16UsbTail = 0;       // Written by UsbLink_vConsume, reset on SET_CONFIGURATION
+static volatile uint16 Global_u16UsbReleased = 0;   // Written by UsbLink_vRelease, reset on SET_CONFIGURATION
+static volatile uint8 Global_u8OutPaused = 1;       // Bulk OUT not armed (not configured or ring full)
+static volatile uint8 Global_u8TxBusy = 0;          // Bulk IN transfer in progress
+static volatile uint8 Global_u8Configured = 0;      // SET_CONFIGURATION received
+static uint8 Global_u8Ep0DataStage = 0;             // EP0 sent a data stage, the host answers with a status OUT
+static uint8 Global_u8arrEp0Buffer[USB_MAX_PACKET];
+
+/**
+ * @brief  Arms the bulk OUT endpoint at the ring head if a whole packet fits in front of the released
+ *         bytes, otherwise leaves it paused. Called from the USB interrupt or with interrupts masked.
+ * @retval None
+ */
+static void UsbLink_vArmOut(void)
+{
+    if ((USB_RX_RING_SIZE - (uint16)(Global_u16UsbHead - Global_u16UsbReleased)) >= USB_MAX_PACKET)
+    {
+        Global_u8OutPaused = 0;
+        HAL_PCD_EP_Receive(USB_PORT, USB_BULK_OUT_EP,
+                           &Global_u8arrUsbRing[Global_u16UsbHead & (USB_RX_RING_SIZE - 1u)], USB_MAX_PACKET);
+    }
+    else
+    {
+        Global_u8OutPaused = 1;
+    }
+}
+
+/**
+ * @brief  Sends a control IN data stage, truncated to the length the host asked for.
+ * @retval None
+ */
+static void UsbLink_vControlSend(const uint8* Data, uint16 Length, uint16 Copy_u16Requested)
+{
+    if (Length > Copy_u16Requested)
+    {
+        Length = Copy_u16Requested;
+    }
+    Global_u8Ep0DataStage = 1;
+    HAL_PCD_EP_Transmit(USB_PORT, 0x80, (uint8*)Data, Length);
+}
+
+/**
+ * @brief  Builds a string descriptor, index 0 is the language list and index 3 the unique device ID in hex.
+ * @retval uint16: Descriptor length, 0 for an unknown index.
+ */
+static uint16 UsbLink_u16StringDescriptor(uint8 Copy_u8Index, uint8* Copy_pu8Descriptor)
+{
+    uint16 Local_u16Length = 2;
+    uint8 Local_u8Counter = 0;
+
+    if (0u == Copy_u8Index)
+    {
+        Copy_pu8Descriptor[2] = 0x09;                       // English (United States)
+        Copy_pu8Descriptor[3] = 0x04;
+        Local_u16Length = 4;
+    }
+    else if (3u == Copy_u8Index)
+    {
+        const uint8* Local_pu8Uid = (const uint8*)USB_UID_ADDRESS;
+
+        for (Local_u8Counter = 0; Local_u8Counter < 24u; Local_u8Counter++)
+        {
+            uint8 Local_u8Nibble = (Local_pu8Uid[Local_u8Counter / 2u] >> ((Local_u8Counter & 1u) ? 0u : 4u)) & 0x0Fu;
+
+            Copy_pu8Descriptor[Local_u16Length] = ((Local_u8Nibble < 10u) ? (uint8)('0' + Local_u8Nibble) : (uint8)('A' + Local_u8Nibble - 10u));
+            Copy_pu8Descriptor[Local_u16Length + 1u] = 0;
+            Local_u16Length += 2u;
+        }
+    }
+    else if (Copy_u8Index < (uint8)(sizeof(Global_pcarrStrings) / sizeof(Global_pcarrStrings[0])))
+    {
+        const char* Local_pcString = Global_pcarrStrings[Copy_u8Index];
+
+        while (*Local_pcString != '\0')
+        {
+            Copy_pu8Descriptor[Local_u16Length] = (uint8)*Local_pcString++;
+            Copy_pu8Descriptor[Local_u16Length + 1u] = 0;
+            Local_u16Length += 2u;
+        }
+    }
+    else
+    {
+        Local_u16Length = 0;
+    }
+
+    Copy_pu8Descriptor[0] = (uint8)Local_u16Length;
+    Copy_pu8Descriptor[1] = USB_DESC_STRING;
+
+    return Local_u16Length;
+}
+
+/**
+ * @brief  Sets up the packet memory and connects to the host.
+ * @retval None
+ */
+void UsbLink_vInit(void)
+{
+    HAL_PCDEx_PMAConfig(USB_PORT, 0x00, PCD_SNG_BUF, USB_PMA_EP0_OUT);
+    HAL_PCDEx_PMAConfig(USB_PORT, 0x80, PCD_SNG_BUF, USB_PMA_EP0_IN);
+    HAL_PCDEx_PMAConfig(USB_PORT, USB_BULK_OUT_EP, PCD_SNG_BUF, USB_PMA_BULK_OUT);
+    HAL_PCDEx_PMAConfig(USB_PORT, USB_BULK_IN_EP, PCD_SNG_BUF, USB_PMA_BULK_IN);
+    HAL_PCD_Start(USB_PORT);
+}
+
+/**
+ * @brief  Disconnects from the host and stops the USB clock and interrupt before jumping to the application.
+ * @retval None
+ */
+void UsbLink_vDeInit(void)
+{
+    HAL_PCD_DeInit(USB_PORT);
+}
+
+/**
+ * @brief  Returns the number of received bytes that were not consumed yet.
+ * @retval uint16: Pending bytes.
+ */
+uint16 UsbLink_u16Available(void)
+{
+    return (uint16)(Global_u16UsbHead - Global_u16UsbTail);
+}
+
+/**
+ * @brief  Returns the next bytes of the ring as one contiguous block, the wrapped part is mirrored
+ *         behind the ring like the UART receive ring.
+ * @param  Copy_u16Length: Number of bytes the caller reads, at most USB_RX_MIRROR_SIZE.
+ * @retval uint8*: Pointer to the first byte.
+ */
+uint8* UsbLink_pu8Peek(uint16 Copy_u16Length)
+{
+    uint16 Local_u16Offset = Global_u16UsbTail & (USB_RX_RING_SIZE - 1u);
+
+    if ((Local_u16Offset + Copy_u16Length) > USB_RX_RING_SIZE)
+    {
+        memcpy(&Global_u8arrUsbRing[USB_RX_RING_SIZE], Global_u8arrUsbRing, (Local_u16Offset + Copy_u16Length) - USB_RX_RING_SIZE);
+    }
+
+    return &Global_u8arrUsbRing[Local_u16Offset];
+}
+
+/**
+ * @brief  Moves the tail past bytes that were read. They stay reserved until UsbLink_vRelease().
+ * @param  Copy_u16Length: Number of bytes read.
+ * @retval None
+ */
+void UsbLink_vConsume(uint16 Copy_u16Length)
+{
+    Global_u16UsbTail += Copy_u16Length;
+}
+
+/**
+ * @brief  Lets the bulk OUT endpoint overwrite every byte consumed so far, and re-arms it if it was
+ *         paused on a full ring.
+ * @retval None
+ */
+void UsbLink_vRelease(void)
+{
+    uint32 Local_u32Primask = __get_PRIMASK();
+
+    __disable_irq();
+    Global_u16UsbReleased = Global_u16UsbTail;
+    if (Global_u8Configured && Global_u8OutPaused)
+    {
+        UsbLink_vArmOut();
+    }
+    __set_PRIMASK(Local_u32Primask);
+}
+
+/**
+ * @brief  Starts one bulk IN transfer and waits until the host has read it or USB_TX_TIMEOUT expires.
+ * @retval None
+ */
+static void UsbLink_vTransmit(const uint8* Data, uint16 Length)
+{
+    uint32 Local_u32Start = HAL_GetTick();
+
+    Global_u8TxBusy = 1;
+    HAL_PCD_EP_Transmit(USB_PORT, USB_BULK_IN_EP, (uint8*)Data, Length);
+    while (Global_u8TxBusy && Global_u8Configured && ((HAL_GetTick() - Local_u32Start) < USB_TX_TIMEOUT));
+}
+
+/**
+ * @brief  Sends bytes on the bulk IN endpoint, blocking. A transfer that is a multiple of the packet size
+ *         is closed with a zero-length packet so a host read with a larger buffer returns.
+ * @param  Data: Pointer to the bytes to send.
+ * @param  Length: Number of bytes to send.
+ * @retval None
+ */
+void UsbLink_vSend(const uint8* Data, uint16 Length)
+{
+    if (Global_u8Configured && (Length > 0u))
+    {
+        UsbLink_vTransmit(Data, Length);
+        if (0u == (Length % USB_MAX_PACKET))
+        {
+            UsbLink_vTransmit(NULL, 0);
+        }
+    }
+}
+
+/**
+ * @brief  Transport adapter: non-zero once the length byte of a frame arrived.
+ * @retval uint8
+ */
+static uint8 UsbLink_u8Receiving(void)
+{
+    return (uint8)(UsbLink_u16Available() >= 1u);
+}
+
+/**
+ * @brief  Transport adapter: takes the next frame out of the ring once it is complete.
+ *
+ * Like the slot behind the tail of the CAN link, the frame stays reserved while it is handled: its
+ * bytes (and their mirror copy) are released only by the next call, when the handler is done with it.
+ * Until then the bulk OUT endpoint is not armed over them.
+ * @retval Pointer to the length byte of the frame, NULL while the frame is incomplete.
+ */
+static uint8* UsbLink_pu8ReceiveFrame(void)
+{
+    uint8* Local_pu8Frame = NULL;
+    uint16 Local_u16FrameLength = 0;
+
+    // The frame returned by the previous call has been handled
+    UsbLink_vRelease();
+
+    if (UsbLink_u16Available() >= 1u)
+    {
+        Local_u16FrameLength = (uint16)UsbLink_pu8Peek(1u)[0] + 1u;
+        if (UsbLink_u16Available() >= Local_u16FrameLength)
+        {
+            Local_pu8Frame = UsbLink_pu8Peek(Local_u16FrameLength);
+            UsbLink_vConsume(Local_u16FrameLength);
+        }
+    }
+
+    return Local_pu8Frame;
+}
+
+/**
+ * @brief  Transport adapter: drops the received bytes of a frame that stayed incomplete for FRAME_TIMEOUT.
+ * @retval None
+ */
+static void UsbLink_vDiscard(void)
+{
+    UsbLink_vConsume(UsbLink_u16Available());
+    UsbLink_vRelease();
+}
+
+/**
+ * @brief  Transport adapter: the segments are staged and sent as one bulk transfer.
+ * @retval None
+ */
+static void UsbLink_vSendGather(const TRANSPORT_segment* Segments, uint8 Count)
+{
+    Transport_vSendGatherCopy(Segments, Count, UsbLink_vSend);
+}
+
+/**
+ * @brief  Transport adapter: UsbLink_vSend only returns once the host read the data, nothing is pending.
+ * @retval None
+ */
+static void UsbLink_vFlush(void)
+{
+}
+
+/**
+ * @brief  Transport adapter: full-speed signalling rate.
+ * @retval uint32: bit/s
+ */
+static uint32 UsbLink_u32LinkSpeed(void)
+{
+    return USB_LINK_SPEED;
+}
+
+const TRANSPORT_backend UsbLink_stTransport =
+{
+    UsbLink_u8Receiving,
+    UsbLink_pu8ReceiveFrame,
+    UsbLink_vDiscard,
+    UsbLink_vSend,
+    UsbLink_vSendGather,
+    UsbLink_vFlush,
+    UsbLink_u32LinkSpeed,
+};
+
+/**
+ * @brief  Bus reset: the device is unconfigured and only the control endpoint is open.
+ */
+void HAL_PCD_ResetCallback(PCD_HandleTypeDef *hpcd)
+{
+    Global_u8Configured = 0;
+    Global_u8OutPaused = 1;
+    Global_u8TxBusy = 0;
+    HAL_PCD_EP_Open(hpcd, 0x00, USB_MAX_PACKET, EP_TYPE_CTRL);
+    HAL_PCD_EP_Open(hpcd, 0x80, USB_MAX_PACKET, EP_TYPE_CTRL);
+}
+
+/**
+ * @brief  Handles the standard requests needed to enumerate, everything else is stalled.
+ */
+void HAL_PCD_SetupStageCallback(PCD_HandleTypeDef *hpcd)
+{
+    const uint8* Local_pu8Setup = (const uint8*)hpcd->Setup;
+    uint8 Local_u8Request = Local_pu8Setup[1];
+    uint16 Local_u16Value = (uint16)(Local_pu8Setup[2] | (Local_pu8Setup[3] << 8));
+    uint16 Local_u16Requested = (uint16)(Local_pu8Setup[6] | (Local_pu8Setup[7] << 8));
+    uint8 Local_u8Stall = 0;
+
+    Global_u8Ep0DataStage = 0;
+
+    if (0u != (Local_pu8Setup[0] & USB_REQ_TYPE_MASK))
+    {
+        Local_u8Stall = 1;
+    }
+    else if (USB_REQ_GET_DESCRIPTOR == Local_u8Request)
+    {
+        uint8 Local_u8Type = (uint8)(Local_u16Value >> 8);
+
+        if (USB_DESC_DEVICE == Local_u8Type)
+        {
+            UsbLink_vControlSend(Global_u8arrDeviceDescriptor, sizeof(Global_u8arrDeviceDescriptor), Local_u16Requested);
+        }
+        else if (USB_DESC_CONFIGURATION == Local_u8Type)
+        {
+            UsbLink_vControlSend(Global_u8arrConfigDescriptor, sizeof(Global_u8arrConfigDescriptor), Local_u16Requested);
+        }
+        else if ((USB_DESC_STRING == Local_u8Type) &&
+                 (0u != UsbLink_u16StringDescriptor((uint8)Local_u16Value, Global_u8arrEp0Buffer)))
+        {
+            UsbLink_vControlSend(Global_u8arrEp0Buffer, Global_u8arrEp0Buffer[0], Local_u16Requested);
+        }
+        else
+        {
+            Local_u8Stall = 1;
+        }
+    }
+    else if (USB_REQ_SET_ADDRESS == Local_u8Request)
+    {
+        // The new address takes effect once the status stage below has been sent
+        HAL_PCD_SetAddress(hpcd, (uint8)(Local_u16Value & 0x7Fu));
+        HAL_PCD_EP_Transmit(hpcd, 0x80, NULL, 0);
+    }
+    else if (USB_REQ_SET_CONFIGURATION == Local_u8Request)
+    {
+        if (Global_u8Configured)
+        {
+            HAL_PCD_EP_Close(hpcd, USB_BULK_OUT_EP);
+            HAL_PCD_EP_Close(hpcd, USB_BULK_IN_EP);
+            Global_u8Configured = 0;
+        }
+        if (1u == Local_u16Value)
+        {
+            HAL_PCD_EP_Open(hpcd, USB_BULK_OUT_EP, USB_MAX_PACKET, EP_TYPE_BULK);
+            HAL_PCD_EP_Open(hpcd, USB_BULK_IN_EP, USB_MAX_PACKET, EP_TYPE_BULK);
+            Global_u16UsbTail = Global_u16UsbHead;
+            Global_u16UsbReleased = Global_u16UsbHead;
+            Global_u8Configured = 1;
+            UsbLink_vArmOut();
+        }
+        HAL_PCD_EP_Transmit(hpcd, 0x80, NULL, 0);
+    }
+    else if (USB_REQ_GET_CONFIGURATION == Local_u8Request)
+    {
+        Global_u8arrEp0Buffer[0] = Global_u8Configured;
+        UsbLink_vControlSend(Global_u8arrEp0Buffer, 1, Local_u16Requested);
+    }
+    else if (USB_REQ_GET_STATUS == Local_u8Request)
+    {
+        Global_u8arrEp0Buffer[0] = 0;
+        Global_u8arrEp0Buffer[1] = 0;
+        UsbLink_vControlSend(Global_u8arrEp0Buffer, 2, Local_u16Requested);
+    }
+    else
+    {
+        Local_u8Stall = 1;
+    }
+
+    if (Local_u8Stall)
+    {
+        HAL_PCD_EP_SetStall(hpcd, 0x80);
+        HAL_PCD_EP_SetStall(hpcd, 0x00);
+    }
+}
+
+/**
+ * @brief  Bulk OUT packet received: append it to the ring and re-arm if there is room for the next one.
+ */
+void HAL_PCD_DataOutStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
+{
+    if (epnum == (USB_BULK_OUT_EP & 0x0Fu))
+    {
+        uint16 Local_u16Count = (uint16)HAL_PCD_EP_GetRxCount(hpcd, USB_BULK_OUT_EP);
+        uint16 Local_u16Offset = Global_u16UsbHead & (USB_RX_RING_SIZE - 1u);
+
+        // A packet received across the end of the ring landed in the mirror area, move that part to the start
+        if ((Local_u16Offset + Local_u16Count) > USB_RX_RING_SIZE)
+        {
+            memcpy(Global_u8arrUsbRing, &Global_u8arrUsbRing[USB_RX_RING_SIZE], (Local_u16Offset + Local_u16Count) - USB_RX_RING_SIZE);
+        }
+        Global_u16UsbHead += Local_u16Count;
+        UsbLink_vArmOut();
+    }
+}
+
+/**
+ * @brief  IN transfer complete: ends a bulk reply, or waits for the status stage of a control read.
+ */
+void HAL_PCD_DataInStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
+{
+    if (0u == epnum)
+    {
+        if (Global_u8Ep0DataStage)
+        {
+            Global_u8Ep0DataStage = 0;
+            HAL_PCD_EP_Receive(hpcd, 0x00, NULL, 0);
+        }
+    }
+    else if (epnum == (USB_BULK_IN_EP & 0x0Fu))
+    {
+        Global_u8TxBusy = 0;
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef USBLINK_H
+#define USBLINK_H
+
+/********************************************Library Include Start********************************************/
+#include "STD_TYPES.h"   // Standard type definitions
+#include "usb.h"         // USB device peripheral handle
+#include "Transport.h"   // Transport backend interface
+/********************************************Library Include End********************************************/
+
+/**************************************UsbLink Macros Declaration Start**************************************/
+#define USB_PORT                               &hpcd_USB_FS // USB device handle
+#define USB_VENDOR_ID                          0x0483u      // Vendor ID reported in the device descriptor
+#define USB_PRODUCT_ID                         0x5750u      // Product ID reported in the device descriptor
+#define USB_MAX_PACKET                         64u          // Full-speed packet size of every endpoint
+#define USB_BULK_OUT_EP                        0x01u        // Host to device frames
+#define USB_BULK_IN_EP                         0x81u        // Device to host replies
+#define USB_RX_RING_SIZE                       512u         // Bulk OUT ring size (power of two, at least two frames)
+#define USB_RX_MIRROR_SIZE                     256u         // Area behind the ring that keeps a frame or a packet contiguous
+#define USB_TX_TIMEOUT                         1000u        // ms to wait for the host to read a reply
+#define USB_LINK_SPEED                         12000000u    // Full-speed signalling rate in bit/s
+
+// Packet memory layout: the buffer table takes the first 16 bytes, then one 64-byte buffer per endpoint
+#define USB_PMA_EP0_OUT                        0x18u
+#define USB_PMA_EP0_IN                         0x58u
+#define USB_PMA_BULK_OUT                       0x98u
+#define USB_PMA_BULK_IN                        0xD8u
+/***************************************UsbLink Macros Declaration End***************************************/
+
+/*************************************UsbLink Variable Declaration Start*************************************/
+extern const TRANSPORT_backend UsbLink_stTransport;            // Bulk endpoints as a transport backend
+/**************************************UsbLink Variable Declaration End**************************************/
+
+/*************************************UsbLink Function Declaration Start*************************************/
+void UsbLink_vInit(void);                                       // Configure the packet memory and connect
+void UsbLink_vDeInit(void);                                     // Disconnect before leaving the bootloader
+uint16 UsbLink_u16Available(void);                              // Received bytes not consumed yet
+uint8* UsbLink_pu8Peek(uint16 Copy_u16Length);                  // Contiguous view of the next Copy_u16Length bytes
+void UsbLink_vConsume(uint16 Copy_u16Length);                   // Move the tail past bytes that were read, they stay reserved
+void UsbLink_vRelease(void);                                    // Free the consumed bytes and resume reception if it was paused
+void UsbLink_vSend(const uint8* Data, uint16 Length);           // Send bytes on the bulk IN endpoint, blocking
+/**************************************UsbLink Function Declaration End**************************************/
+
+#endif
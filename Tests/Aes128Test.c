@@ -0,0 +1,95 @@
+/*
+ * Known-answer test of Aes128.c, runs on the host:
+ *     cc -IBootloader Tests/Aes128Test.c Bootloader/Aes128.c -o aes128_test && ./aes128_test
+ * The vectors are FIPS-197 appendix C.1 (one block) and NIST SP 800-38A F.5.1 (CTR-AES128.Encrypt).
+ */
+
+/********************************************Library Include Start********************************************/
+#include <stdio.h>       // Test report
+#include <string.h>      // memcmp and memcpy
+#include "Aes128.h"      // Cipher under test
+/********************************************Library Include End********************************************/
+
+// FIPS-197 appendix C.1
+static const uint8_t Global_u8arrBlockKey[AES128_KEY_SIZE] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const uint8_t Global_u8arrBlockPlain[AES128_BLOCK_SIZE] =
+{
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+static const uint8_t Global_u8arrBlockCipher[AES128_BLOCK_SIZE] =
+{
+    0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+
+// NIST SP 800-38A F.5.1, the last counter byte wraps between the second and the third block
+static const uint8_t Global_u8arrCtrKey[AES128_KEY_SIZE] =
+{
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const uint8_t Global_u8arrCtrCounter[AES128_BLOCK_SIZE] =
+{
+    0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+static const uint8_t Global_u8arrCtrPlain[4u * AES128_BLOCK_SIZE] =
+{
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+    0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+static const uint8_t Global_u8arrCtrCipher[4u * AES128_BLOCK_SIZE] =
+{
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+    0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+    0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+    0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+
+/**
+ * @brief  Reports one check.
+ * @param  Copy_pcName: Name of the check.
+ * @param  Copy_s32Passed: Nonzero if the check passed.
+ * @retval int: 1 if the check failed, otherwise 0.
+ */
+static int Check(const char *Copy_pcName, int Copy_s32Passed)
+{
+    printf("%-40s %s\n", Copy_pcName, Copy_s32Passed ? "PASSED" : "FAILED");
+    return !Copy_s32Passed;
+}
+
+int main(void)
+{
+    AES128_context Local_stContext;
+    uint8_t Local_u8arrBuffer[4u * AES128_BLOCK_SIZE];
+    uint32_t Local_u32Offset = 0;
+    int Local_s32Failures = 0;
+
+    // Step 1: Single block encryption
+    AES128_vInit(&Local_stContext, Global_u8arrBlockKey);
+    AES128_vEncryptBlock(&Local_stContext, Global_u8arrBlockPlain, Local_u8arrBuffer);
+    Local_s32Failures += Check("FIPS-197 C.1 block", 0 == memcmp(Local_u8arrBuffer, Global_u8arrBlockCipher, AES128_BLOCK_SIZE));
+
+    // Step 2: CTR encryption of the whole message in one call
+    AES128_vInit(&Local_stContext, Global_u8arrCtrKey);
+    memcpy(Local_u8arrBuffer, Global_u8arrCtrPlain, sizeof(Local_u8arrBuffer));
+    AES128_vCtrCrypt(&Local_stContext, Global_u8arrCtrCounter, 0, Local_u8arrBuffer, sizeof(Local_u8arrBuffer));
+    Local_s32Failures += Check("SP 800-38A F.5.1 encrypt", 0 == memcmp(Local_u8arrBuffer, Global_u8arrCtrCipher, sizeof(Local_u8arrBuffer)));
+
+    // Step 3: CTR decryption in unaligned pieces, as the bootloader decrypts frames at their flash offset
+    memcpy(Local_u8arrBuffer, Global_u8arrCtrCipher, sizeof(Local_u8arrBuffer));
+    for (Local_u32Offset = 0; Local_u32Offset < sizeof(Local_u8arrBuffer); Local_u32Offset += 7u)
+    {
+        uint32_t Local_u32Length = sizeof(Local_u8arrBuffer) - Local_u32Offset;
+        if (Local_u32Length > 7u)
+        {
+            Local_u32Length = 7u;
+        }
+        AES128_vCtrCrypt(&Local_stContext, Global_u8arrCtrCounter, Local_u32Offset, &Local_u8arrBuffer[Local_u32Offset], Local_u32Length);
+    }
+    Local_s32Failures += Check("SP 800-38A F.5.1 decrypt at offsets", 0 == memcmp(Local_u8arrBuffer, Global_u8arrCtrPlain, sizeof(Local_u8arrBuffer)));
+
+    return (0 == Local_s32Failures) ? 0 : 1;
+}
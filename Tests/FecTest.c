@@ -0,0 +1,256 @@
+/*
+ * Test of the Reed-Solomon decoder in Fec.c, runs on the host:
+ *     cc -IBootloader Tests/FecTest.c Bootloader/Fec.c -o fec_test && ./fec_test
+ * The codewords come from the reference encoder below, which shares no tables with the decoder: it
+ * multiplies in GF(2^8) bit by bit and divides by the generator polynomial with roots alpha^0 ..
+ * alpha^(ParitySize - 1), first byte highest, like the host encoder. Every error count up to
+ * ParitySize / 2 runs Berlekamp-Massey, the Chien search and Forney.
+ */
+
+/********************************************Library Include Start********************************************/
+#include <stdio.h>       // Test report
+#include <string.h>      // memcmp and memcpy
+#include "Fec.h"         // Decoder under test
+/********************************************Library Include End********************************************/
+
+#define FIELD_POLYNOMIAL                       0x11Du       // x^8 + x^4 + x^3 + x^2 + 1
+#define TRIALS_PER_CASE                        20u          // Random error patterns per parity size, length and error count
+
+static const uint8_t Global_u8arrParitySizes[] = { 2, 4, 8, 16, FEC_MAX_PARITY_SIZE };
+static const uint16_t Global_u16arrLengths[] = { 0, 64, FEC_MAX_CODEWORD_SIZE };   // 0: one data byte
+
+static uint32_t Global_u32Seed = 0x12345678u;
+
+/**
+ * @brief  Reports one check.
+ * @param  Copy_pcName: Name of the check.
+ * @param  Copy_s32Passed: Nonzero if the check passed.
+ * @retval int: 1 if the check failed, otherwise 0.
+ */
+static int Check(const char *Copy_pcName, int Copy_s32Passed)
+{
+    printf("%-40s %s\n", Copy_pcName, Copy_s32Passed ? "PASSED" : "FAILED");
+    return !Copy_s32Passed;
+}
+
+/**
+ * @brief  Deterministic pseudo-random numbers, so a failure can be reproduced.
+ * @retval uint32_t: Next value.
+ */
+static uint32_t Random(void)
+{
+    Global_u32Seed = (Global_u32Seed * 1103515245u) + 12345u;
+    return Global_u32Seed >> 8;
+}
+
+/**
+ * @brief  GF(2^8) product by shift and add, independent of the decoder's log tables.
+ * @retval uint8_t: a * b
+ */
+static uint8_t GfMul(uint8_t a, uint8_t b)
+{
+    uint16_t Local_u16A = a;
+    uint8_t Local_u8Product = 0;
+
+    while (b != 0u)
+    {
+        if (b & 1u)
+        {
+            Local_u8Product ^= (uint8_t)Local_u16A;
+        }
+        Local_u16A <<= 1;
+        if (Local_u16A & 0x100u)
+        {
+            Local_u16A ^= FIELD_POLYNOMIAL;
+        }
+        b >>= 1;
+    }
+
+    return Local_u8Product;
+}
+
+/**
+ * @brief  Appends ParitySize parity bytes to the data: the remainder of data(x) * x^ParitySize divided by
+ *         the generator polynomial (x - alpha^0) .. (x - alpha^(ParitySize - 1)).
+ * @param  Codeword: Data bytes, the parity is written behind them.
+ * @param  Copy_u16DataLength: Number of data bytes.
+ * @param  Copy_u8ParitySize: Number of parity bytes.
+ * @retval None
+ */
+static void Encode(uint8_t *Codeword, uint16_t Copy_u16DataLength, uint8_t Copy_u8ParitySize)
+{
+    uint8_t Local_u8arrGenerator[FEC_MAX_PARITY_SIZE + 1u];   // Highest coefficient first, monic
+    uint8_t Local_u8arrRemainder[FEC_MAX_PARITY_SIZE];
+    uint8_t Local_u8Root = 1;
+    uint8_t Local_u8Feedback = 0;
+    uint16_t Local_u16Index = 0;
+    uint8_t Local_u8Term = 0;
+
+    // Step 1: Multiply out the generator polynomial one root at a time
+    memset(Local_u8arrGenerator, 0, sizeof(Local_u8arrGenerator));
+    Local_u8arrGenerator[0] = 1u;
+    for (Local_u8Term = 0; Local_u8Term < Copy_u8ParitySize; Local_u8Term++)
+    {
+        for (Local_u16Index = (uint16_t)(Local_u8Term + 1u); Local_u16Index > 0u; Local_u16Index--)
+        {
+            Local_u8arrGenerator[Local_u16Index] ^= GfMul(Local_u8arrGenerator[Local_u16Index - 1u], Local_u8Root);
+        }
+        Local_u8Root = GfMul(Local_u8Root, 2u);
+    }
+
+    // Step 2: Long division of the data, the remainder is the parity
+    memset(Local_u8arrRemainder, 0, sizeof(Local_u8arrRemainder));
+    for (Local_u16Index = 0; Local_u16Index < Copy_u16DataLength; Local_u16Index++)
+    {
+        Local_u8Feedback = Codeword[Local_u16Index] ^ Local_u8arrRemainder[0];
+        for (Local_u8Term = 0; (Local_u8Term + 1u) < Copy_u8ParitySize; Local_u8Term++)
+        {
+            Local_u8arrRemainder[Local_u8Term] = Local_u8arrRemainder[Local_u8Term + 1u] ^ GfMul(Local_u8Feedback, Local_u8arrGenerator[Local_u8Term + 1u]);
+        }
+        Local_u8arrRemainder[Copy_u8ParitySize - 1u] = GfMul(Local_u8Feedback, Local_u8arrGenerator[Copy_u8ParitySize]);
+    }
+    memcpy(&Codeword[Copy_u16DataLength], Local_u8arrRemainder, Copy_u8ParitySize);
+}
+
+/**
+ * @brief  Builds a random codeword of the requested length.
+ * @retval None
+ */
+static void RandomCodeword(uint8_t *Codeword, uint16_t Copy_u16Length, uint8_t Copy_u8ParitySize)
+{
+    uint16_t Local_u16Index = 0;
+
+    for (Local_u16Index = 0; Local_u16Index < (Copy_u16Length - Copy_u8ParitySize); Local_u16Index++)
+    {
+        Codeword[Local_u16Index] = (uint8_t)Random();
+    }
+    Encode(Codeword, (uint16_t)(Copy_u16Length - Copy_u8ParitySize), Copy_u8ParitySize);
+}
+
+/**
+ * @brief  Adds a non-zero error to Copy_u8Count distinct random bytes. The first and the last byte of
+ *         the codeword are hit in every other pattern, the ends of the Chien search.
+ * @retval None
+ */
+static void AddErrors(uint8_t *Codeword, uint16_t Copy_u16Length, uint8_t Copy_u8Count, uint32_t Copy_u32Trial)
+{
+    uint8_t Local_u8arrHit[FEC_MAX_CODEWORD_SIZE];
+    uint16_t Local_u16Position = 0;
+    uint8_t Local_u8Added = 0;
+
+    memset(Local_u8arrHit, 0, sizeof(Local_u8arrHit));
+    while (Local_u8Added < Copy_u8Count)
+    {
+        if ((0u == (Copy_u32Trial & 1u)) && (Local_u8Added < 2u))
+        {
+            Local_u16Position = (0u == Local_u8Added) ? 0u : (uint16_t)(Copy_u16Length - 1u);
+        }
+        else
+        {
+            Local_u16Position = (uint16_t)(Random() % Copy_u16Length);
+        }
+        if (!Local_u8arrHit[Local_u16Position])
+        {
+            Local_u8arrHit[Local_u16Position] = 1u;
+            Codeword[Local_u16Position] ^= (uint8_t)(1u + (Random() % 255u));
+            Local_u8Added++;
+        }
+    }
+}
+
+/**
+ * @brief  Checks that a buffer is a codeword: re-encoding its data bytes gives the same parity.
+ * @retval int: Nonzero for a codeword.
+ */
+static int IsCodeword(const uint8_t *Codeword, uint16_t Copy_u16Length, uint8_t Copy_u8ParitySize)
+{
+    uint8_t Local_u8arrCopy[FEC_MAX_CODEWORD_SIZE];
+
+    memcpy(Local_u8arrCopy, Codeword, Copy_u16Length);
+    Encode(Local_u8arrCopy, (uint16_t)(Copy_u16Length - Copy_u8ParitySize), Copy_u8ParitySize);
+    return 0 == memcmp(Local_u8arrCopy, Codeword, Copy_u16Length);
+}
+
+int main(void)
+{
+    uint8_t Local_u8arrOriginal[FEC_MAX_CODEWORD_SIZE];
+    uint8_t Local_u8arrCodeword[FEC_MAX_CODEWORD_SIZE];
+    uint8_t Local_u8arrCorrupted[FEC_MAX_CODEWORD_SIZE];
+    uint32_t Local_u32Parity = 0;
+    uint32_t Local_u32Size = 0;
+    uint32_t Local_u32Trial = 0;
+    uint16_t Local_u16Length = 0;
+    uint8_t Local_u8ParitySize = 0;
+    uint8_t Local_u8Errors = 0;
+    uint8_t Local_u8Result = 0;
+    int Local_s32Clean = 1;
+    int Local_s32Corrected = 1;
+    int Local_s32Beyond = 1;
+    int Local_s32Failures = 0;
+
+    for (Local_u32Parity = 0; Local_u32Parity < sizeof(Global_u8arrParitySizes); Local_u32Parity++)
+    {
+        Local_u8ParitySize = Global_u8arrParitySizes[Local_u32Parity];
+        for (Local_u32Size = 0; Local_u32Size < (sizeof(Global_u16arrLengths) / sizeof(Global_u16arrLengths[0])); Local_u32Size++)
+        {
+            Local_u16Length = (0u == Global_u16arrLengths[Local_u32Size]) ? (uint16_t)(Local_u8ParitySize + 1u) : Global_u16arrLengths[Local_u32Size];
+
+            // Step 1: A clean codeword only costs the syndromes and is left as it is
+            RandomCodeword(Local_u8arrOriginal, Local_u16Length, Local_u8ParitySize);
+            memcpy(Local_u8arrCodeword, Local_u8arrOriginal, Local_u16Length);
+            Local_s32Clean = Local_s32Clean && (0u == FEC_u8Decode(Local_u8arrCodeword, Local_u16Length, Local_u8ParitySize)) &&
+                             (0 == memcmp(Local_u8arrCodeword, Local_u8arrOriginal, Local_u16Length));
+
+            // Step 2: 1 .. ParitySize / 2 errors are located and corrected
+            for (Local_u8Errors = 1; Local_u8Errors <= (Local_u8ParitySize / 2u); Local_u8Errors++)
+            {
+                for (Local_u32Trial = 0; Local_u32Trial < TRIALS_PER_CASE; Local_u32Trial++)
+                {
+                    RandomCodeword(Local_u8arrOriginal, Local_u16Length, Local_u8ParitySize);
+                    memcpy(Local_u8arrCodeword, Local_u8arrOriginal, Local_u16Length);
+                    AddErrors(Local_u8arrCodeword, Local_u16Length, Local_u8Errors, Local_u32Trial);
+                    Local_u8Result = FEC_u8Decode(Local_u8arrCodeword, Local_u16Length, Local_u8ParitySize);
+                    if ((Local_u8Result != Local_u8Errors) || (0 != memcmp(Local_u8arrCodeword, Local_u8arrOriginal, Local_u16Length)))
+                    {
+                        printf("    parity %u, length %u, %u errors, trial %lu: returned %u\n", Local_u8ParitySize,
+                               Local_u16Length, Local_u8Errors, (unsigned long)Local_u32Trial, Local_u8Result);
+                        Local_s32Corrected = 0;
+                    }
+                }
+            }
+
+            // Step 3: One error too many is refused with the codeword untouched, or at worst decoded to
+            //         another codeword, never to a buffer the host did not encode
+            Local_u8Errors = (uint8_t)((Local_u8ParitySize / 2u) + 1u);
+            for (Local_u32Trial = 0; (Local_u8Errors <= Local_u16Length) && (Local_u32Trial < TRIALS_PER_CASE); Local_u32Trial++)
+            {
+                RandomCodeword(Local_u8arrOriginal, Local_u16Length, Local_u8ParitySize);
+                memcpy(Local_u8arrCodeword, Local_u8arrOriginal, Local_u16Length);
+                AddErrors(Local_u8arrCodeword, Local_u16Length, Local_u8Errors, Local_u32Trial);
+                memcpy(Local_u8arrCorrupted, Local_u8arrCodeword, Local_u16Length);
+                Local_u8Result = FEC_u8Decode(Local_u8arrCodeword, Local_u16Length, Local_u8ParitySize);
+                if (FEC_UNCORRECTABLE == Local_u8Result)
+                {
+                    Local_s32Beyond = Local_s32Beyond && (0 == memcmp(Local_u8arrCodeword, Local_u8arrCorrupted, Local_u16Length));
+                }
+                else
+                {
+                    Local_s32Beyond = Local_s32Beyond && (Local_u8Result <= (Local_u8ParitySize / 2u)) &&
+                                      IsCodeword(Local_u8arrCodeword, Local_u16Length, Local_u8ParitySize);
+                }
+            }
+        }
+    }
+    Local_s32Failures += Check("Clean codewords unchanged", Local_s32Clean);
+    Local_s32Failures += Check("Up to ParitySize / 2 errors corrected", Local_s32Corrected);
+    Local_s32Failures += Check("One error too many refused", Local_s32Beyond);
+
+    // Step 4: Parameters outside the decoder's limits
+    Local_s32Failures += Check("Invalid parameters refused",
+                               (FEC_UNCORRECTABLE == FEC_u8Decode(Local_u8arrCodeword, 10, 0)) &&
+                               (FEC_UNCORRECTABLE == FEC_u8Decode(Local_u8arrCodeword, 10, FEC_MAX_PARITY_SIZE + 2u)) &&
+                               (FEC_UNCORRECTABLE == FEC_u8Decode(Local_u8arrCodeword, 8, 8)) &&
+                               (FEC_UNCORRECTABLE == FEC_u8Decode(Local_u8arrCodeword, FEC_MAX_CODEWORD_SIZE + 1u, 8)));
+
+    return (0 == Local_s32Failures) ? 0 : 1;
+}
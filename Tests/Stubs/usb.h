@@ -0,0 +1,59 @@
+/*
+ * Host stand-in for the CubeMX usb.h, so UsbLink.c builds without the HAL. It declares the part of the
+ * HAL PCD driver and CMSIS that UsbLink.c uses, the test defines the functions.
+ */
+#ifndef __USB_H__
+#define __USB_H__
+
+/********************************************Library Include Start********************************************/
+#include <stddef.h>      // NULL
+#include <stdint.h>      // Fixed-width types of the HAL prototypes
+/********************************************Library Include End********************************************/
+
+/****************************************Stub Macros Declaration Start****************************************/
+#define EP_TYPE_CTRL                           0u
+#define EP_TYPE_BULK                           2u
+#define PCD_SNG_BUF                            0u
+/*****************************************Stub Macros Declaration End*****************************************/
+
+/***************************************Stub DataType Declaration Start***************************************/
+typedef enum
+{
+    HAL_OK,
+    HAL_ERROR,
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+    uint32_t Setup[12];                     // Last SETUP packet, as filled in by the HAL driver
+} PCD_HandleTypeDef;
+/****************************************Stub DataType Declaration End****************************************/
+
+/*************************************Stub Variable Declaration Start*************************************/
+extern PCD_HandleTypeDef hpcd_USB_FS;
+/**************************************Stub Variable Declaration End**************************************/
+
+/*************************************Stub Function Declaration Start*************************************/
+uint32_t HAL_GetTick(void);
+HAL_StatusTypeDef HAL_PCD_Start(PCD_HandleTypeDef *hpcd);
+HAL_StatusTypeDef HAL_PCD_DeInit(PCD_HandleTypeDef *hpcd);
+HAL_StatusTypeDef HAL_PCD_SetAddress(PCD_HandleTypeDef *hpcd, uint8_t address);
+HAL_StatusTypeDef HAL_PCD_EP_Open(PCD_HandleTypeDef *hpcd, uint8_t ep_addr, uint16_t ep_mps, uint8_t ep_type);
+HAL_StatusTypeDef HAL_PCD_EP_Close(PCD_HandleTypeDef *hpcd, uint8_t ep_addr);
+HAL_StatusTypeDef HAL_PCD_EP_Receive(PCD_HandleTypeDef *hpcd, uint8_t ep_addr, uint8_t *pBuf, uint32_t len);
+HAL_StatusTypeDef HAL_PCD_EP_Transmit(PCD_HandleTypeDef *hpcd, uint8_t ep_addr, uint8_t *pBuf, uint32_t len);
+HAL_StatusTypeDef HAL_PCD_EP_SetStall(PCD_HandleTypeDef *hpcd, uint8_t ep_addr);
+uint32_t HAL_PCD_EP_GetRxCount(PCD_HandleTypeDef *hpcd, uint8_t ep_addr);
+HAL_StatusTypeDef HAL_PCDEx_PMAConfig(PCD_HandleTypeDef *hpcd, uint16_t ep_addr, uint16_t ep_kind, uint32_t pmaadress);
+void HAL_PCD_ResetCallback(PCD_HandleTypeDef *hpcd);
+void HAL_PCD_SetupStageCallback(PCD_HandleTypeDef *hpcd);
+void HAL_PCD_DataOutStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum);
+void HAL_PCD_DataInStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum);
+
+// Single-threaded on the host: the "interrupt" runs only when the test calls the callback
+static inline uint32_t __get_PRIMASK(void) { return 0u; }
+static inline void __set_PRIMASK(uint32_t priMask) { (void)priMask; }
+static inline void __disable_irq(void) {}
+/**************************************Stub Function Declaration End**************************************/
+
+#endif
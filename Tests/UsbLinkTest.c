@@ -0,0 +1,189 @@
+/*
+ * Host test of the bulk OUT ring of UsbLink.c: packets appended across the end of the ring, frames made
+ * contiguous through the mirror, frames split over packets or sharing one, the handled frame kept out of
+ * reach of new packets, and Discard(). The HAL PCD driver is replaced by Tests/Stubs/usb.h and the
+ * functions below:
+ *     cc -ITests/Stubs -IBootloader Tests/UsbLinkTest.c Bootloader/UsbLink.c Bootloader/Transport.c -o usblink_test && ./usblink_test
+ */
+
+/********************************************Library Include Start********************************************/
+#include <stdio.h>       // Test report
+#include <string.h>      // memcmp and memcpy
+#include "UsbLink.h"     // Link under test
+/********************************************Library Include End********************************************/
+
+#define FRAME_MAX                              256u         // Length byte and up to 255 bytes behind it
+
+PCD_HandleTypeDef hpcd_USB_FS;
+
+// Buffer the bulk OUT endpoint was armed with, NULL while it is paused
+static uint8_t* Global_pu8OutBuffer = NULL;
+static uint32_t Global_u32OutCount = 0;
+
+/********************************************HAL Stub Start********************************************/
+uint32_t HAL_GetTick(void) { return 0u; }
+HAL_StatusTypeDef HAL_PCD_Start(PCD_HandleTypeDef *hpcd) { (void)hpcd; return HAL_OK; }
+HAL_StatusTypeDef HAL_PCD_DeInit(PCD_HandleTypeDef *hpcd) { (void)hpcd; return HAL_OK; }
+HAL_StatusTypeDef HAL_PCD_SetAddress(PCD_HandleTypeDef *hpcd, uint8_t address) { (void)hpcd; (void)address; return HAL_OK; }
+HAL_StatusTypeDef HAL_PCD_EP_Open(PCD_HandleTypeDef *hpcd, uint8_t ep_addr, uint16_t ep_mps, uint8_t ep_type) { (void)hpcd; (void)ep_addr; (void)ep_mps; (void)ep_type; return HAL_OK; }
+HAL_StatusTypeDef HAL_PCD_EP_Close(PCD_HandleTypeDef *hpcd, uint8_t ep_addr) { (void)hpcd; (void)ep_addr; return HAL_OK; }
+HAL_StatusTypeDef HAL_PCD_EP_SetStall(PCD_HandleTypeDef *hpcd, uint8_t ep_addr) { (void)hpcd; (void)ep_addr; return HAL_OK; }
+HAL_StatusTypeDef HAL_PCDEx_PMAConfig(PCD_HandleTypeDef *hpcd, uint16_t ep_addr, uint16_t ep_kind, uint32_t pmaadress) { (void)hpcd; (void)ep_addr; (void)ep_kind; (void)pmaadress; return HAL_OK; }
+uint32_t HAL_PCD_EP_GetRxCount(PCD_HandleTypeDef *hpcd, uint8_t ep_addr) { (void)hpcd; (void)ep_addr; return Global_u32OutCount; }
+
+HAL_StatusTypeDef HAL_PCD_EP_Receive(PCD_HandleTypeDef *hpcd, uint8_t ep_addr, uint8_t *pBuf, uint32_t len)
+{
+    (void)hpcd;
+    if ((USB_BULK_OUT_EP == ep_addr) && (USB_MAX_PACKET == len))
+    {
+        Global_pu8OutBuffer = pBuf;
+    }
+    return HAL_OK;
+}
+
+// Replies are not looked at, the IN transfer completes at once
+HAL_StatusTypeDef HAL_PCD_EP_Transmit(PCD_HandleTypeDef *hpcd, uint8_t ep_addr, uint8_t *pBuf, uint32_t len)
+{
+    (void)pBuf;
+    (void)len;
+    HAL_PCD_DataInStageCallback(hpcd, ep_addr & 0x0Fu);
+    return HAL_OK;
+}
+/*********************************************HAL Stub End*********************************************/
+
+/**
+ * @brief  Reports one check.
+ * @param  Copy_pcName: Name of the check.
+ * @param  Copy_s32Passed: Nonzero if the check passed.
+ * @retval int: 1 if the check failed, otherwise 0.
+ */
+static int Check(const char *Copy_pcName, int Copy_s32Passed)
+{
+    printf("%-40s %s\n", Copy_pcName, Copy_s32Passed ? "PASSED" : "FAILED");
+    return !Copy_s32Passed;
+}
+
+/**
+ * @brief  Delivers bytes as the host would, in packets of up to USB_MAX_PACKET into the armed buffer.
+ * @param  Data: Bytes to deliver.
+ * @param  Length: Number of bytes.
+ * @retval uint32_t: Bytes delivered before the endpoint was found paused.
+ */
+static uint32_t HostSend(const uint8_t* Data, uint32_t Length)
+{
+    uint32_t Local_u32Sent = 0;
+
+    while ((Local_u32Sent < Length) && (NULL != Global_pu8OutBuffer))
+    {
+        uint32_t Local_u32Packet = Length - Local_u32Sent;
+        uint8_t* Local_pu8Buffer = Global_pu8OutBuffer;
+
+        if (Local_u32Packet > USB_MAX_PACKET)
+        {
+            Local_u32Packet = USB_MAX_PACKET;
+        }
+        Global_pu8OutBuffer = NULL;
+        memcpy(Local_pu8Buffer, &Data[Local_u32Sent], Local_u32Packet);
+        Global_u32OutCount = Local_u32Packet;
+        HAL_PCD_DataOutStageCallback(&hpcd_USB_FS, USB_BULK_OUT_EP);
+        Local_u32Sent += Local_u32Packet;
+    }
+
+    return Local_u32Sent;
+}
+
+/**
+ * @brief  Builds a frame: the length byte, then Copy_u8Length bytes counting up from Copy_u8Seed.
+ * @retval uint32_t: Size of the frame, length byte included.
+ */
+static uint32_t MakeFrame(uint8_t* Frame, uint8_t Copy_u8Length, uint8_t Copy_u8Seed)
+{
+    uint32_t Local_u32Index = 0;
+
+    Frame[0] = Copy_u8Length;
+    for (Local_u32Index = 1; Local_u32Index <= Copy_u8Length; Local_u32Index++)
+    {
+        Frame[Local_u32Index] = (uint8_t)(Copy_u8Seed + Local_u32Index);
+    }
+
+    return (uint32_t)Copy_u8Length + 1u;
+}
+
+int main(void)
+{
+    static const uint8_t Local_u8arrSetConfiguration[8] = { 0x00, 0x09, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    static const uint8_t Local_u8arrLengths[] = { 9, 200, 63, 64, 255, 1, 130, 255, 17, 190 };
+    uint8_t Local_u8arrFrame[FRAME_MAX];
+    uint8_t Local_u8arrNext[2u * FRAME_MAX];
+    uint8_t* Local_pu8Received = NULL;
+    uint32_t Local_u32Size = 0;
+    uint32_t Local_u32NextSize = 0;
+    uint32_t Local_u32Round = 0;
+    int Local_s32Intact = 1;
+    int Local_s32Failures = 0;
+
+    // Step 1: Enumeration ends with SET_CONFIGURATION, which arms the bulk OUT endpoint
+    UsbLink_vInit();
+    HAL_PCD_ResetCallback(&hpcd_USB_FS);
+    memcpy(hpcd_USB_FS.Setup, Local_u8arrSetConfiguration, sizeof(Local_u8arrSetConfiguration));
+    HAL_PCD_SetupStageCallback(&hpcd_USB_FS);
+    Local_s32Failures += Check("OUT armed after SET_CONFIGURATION", NULL != Global_pu8OutBuffer);
+    Local_s32Failures += Check("Idle link not receiving", 0u == UsbLink_stTransport.Receiving());
+
+    // Step 2: A frame split over three packets is only returned once its last byte arrived
+    Local_u32Size = MakeFrame(Local_u8arrFrame, 149, 0x10);
+    HostSend(Local_u8arrFrame, USB_MAX_PACKET);
+    Local_s32Failures += Check("Receiving after the first packet", 0u != UsbLink_stTransport.Receiving());
+    Local_s32Failures += Check("Incomplete frame not returned", NULL == UsbLink_stTransport.ReceiveFrame());
+    HostSend(&Local_u8arrFrame[USB_MAX_PACKET], Local_u32Size - USB_MAX_PACKET);
+    Local_pu8Received = UsbLink_stTransport.ReceiveFrame();
+    Local_s32Failures += Check("Frame split over packets", (NULL != Local_pu8Received) && (0 == memcmp(Local_pu8Received, Local_u8arrFrame, Local_u32Size)));
+
+    // Step 3: One packet holding the end of one frame and the start of the next
+    Local_u32Size = MakeFrame(Local_u8arrNext, 40, 0x20);
+    Local_u32NextSize = MakeFrame(&Local_u8arrNext[Local_u32Size], 50, 0x30);
+    HostSend(Local_u8arrNext, Local_u32Size + Local_u32NextSize);
+    Local_pu8Received = UsbLink_stTransport.ReceiveFrame();
+    Local_s32Intact = (NULL != Local_pu8Received) && (0 == memcmp(Local_pu8Received, Local_u8arrNext, Local_u32Size));
+    Local_pu8Received = UsbLink_stTransport.ReceiveFrame();
+    Local_s32Intact = Local_s32Intact && (NULL != Local_pu8Received) &&
+                      (0 == memcmp(Local_pu8Received, &Local_u8arrNext[Local_u32Size], Local_u32NextSize));
+    Local_s32Failures += Check("Two frames sharing a packet", Local_s32Intact);
+
+    // Step 4: Enough frames to go round the ring several times, packets and frames cross its end
+    Local_s32Intact = 1;
+    for (Local_u32Round = 0; Local_u32Round < 40u; Local_u32Round++)
+    {
+        uint8_t Local_u8Length = Local_u8arrLengths[Local_u32Round % sizeof(Local_u8arrLengths)];
+
+        Local_u32Size = MakeFrame(Local_u8arrFrame, Local_u8Length, (uint8_t)Local_u32Round);
+        Local_s32Intact = Local_s32Intact && (Local_u32Size == HostSend(Local_u8arrFrame, Local_u32Size));
+        Local_pu8Received = UsbLink_stTransport.ReceiveFrame();
+        Local_s32Intact = Local_s32Intact && (NULL != Local_pu8Received) && (0 == memcmp(Local_pu8Received, Local_u8arrFrame, Local_u32Size));
+    }
+    Local_s32Failures += Check("Frames across the ring end", Local_s32Intact);
+
+    // Step 5: The frame being handled is reserved, packets sent meanwhile only fill the rest of the ring
+    Local_u32Size = MakeFrame(Local_u8arrFrame, 255, 0x40);
+    HostSend(Local_u8arrFrame, Local_u32Size);
+    Local_pu8Received = UsbLink_stTransport.ReceiveFrame();
+    Local_u32NextSize = MakeFrame(Local_u8arrNext, 255, 0x50);
+    Local_u32NextSize += MakeFrame(&Local_u8arrNext[Local_u32NextSize], 200, 0x60);
+    Local_u32NextSize = HostSend(Local_u8arrNext, Local_u32NextSize);
+    Local_s32Failures += Check("OUT paused in front of the frame", (Local_u32NextSize <= (USB_RX_RING_SIZE - Local_u32Size)) && (NULL == Global_pu8OutBuffer));
+    Local_s32Failures += Check("Handled frame not overwritten", (NULL != Local_pu8Received) && (0 == memcmp(Local_pu8Received, Local_u8arrFrame, Local_u32Size)));
+    Local_pu8Received = UsbLink_stTransport.ReceiveFrame();
+    Local_s32Failures += Check("OUT re-armed once the frame is released", NULL != Global_pu8OutBuffer);
+    Local_s32Failures += Check("Frame received while paused", (NULL != Local_pu8Received) && (0 == memcmp(Local_pu8Received, Local_u8arrNext, FRAME_MAX)));
+
+    // Step 6: Discard() drops the rest of the paused transfer and a partial frame, the next frame parses
+    HostSend(Local_u8arrNext, 30);
+    UsbLink_stTransport.Discard();
+    Local_s32Failures += Check("Nothing pending after Discard", 0u == UsbLink_stTransport.Receiving());
+    Local_u32Size = MakeFrame(Local_u8arrFrame, 12, 0x70);
+    HostSend(Local_u8arrFrame, Local_u32Size);
+    Local_pu8Received = UsbLink_stTransport.ReceiveFrame();
+    Local_s32Failures += Check("Frame after Discard", (NULL != Local_pu8Received) && (0 == memcmp(Local_pu8Received, Local_u8arrFrame, Local_u32Size)));
+
+    return (0 == Local_s32Failures) ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+/*
+ * Host encryptor for CBL_SET_ENCRYPTION_CMD transfers. It uses the cipher and the key of the bootloader:
+ *     cc -IBootloader Tools/EncryptImage.c Bootloader/Aes128.c -o encrypt_image
+ *     ./encrypt_image <initial counter, 32 hex digits> <image.bin> <image.enc>
+ * Byte n of the image is encrypted at keystream offset n, the offset the bootloader derives from
+ * address - FLASH_SECTOR2_BASE_ADDRESS. Use a fresh initial counter for every image.
+ */
+
+/********************************************Library Include Start********************************************/
+#include <stdio.h>       // File access and error report
+#include <stdlib.h>      // Image buffer
+#include "Aes128.h"      // Same cipher as the bootloader
+#include "ImageKeys.h"   // IMAGE_DECRYPTION_KEY of the product
+/********************************************Library Include End********************************************/
+
+#ifndef IMAGE_DECRYPTION_KEY
+#error "IMAGE_DECRYPTION_KEY is not defined, put the production transfer key in ImageKeys.h"
+#endif
+
+static const uint8_t Global_u8arrKey[AES128_KEY_SIZE] = IMAGE_DECRYPTION_KEY;
+
+/**
+ * @brief  Parses the initial counter block.
+ * @param  Copy_pcHex: 32 hex digits, most significant byte first.
+ * @param  Copy_pu8Counter: Receives the 16-byte counter block.
+ * @retval int: 0 on success, 1 if the string is not 32 hex digits.
+ */
+static int ParseCounter(const char *Copy_pcHex, uint8_t *Copy_pu8Counter)
+{
+    unsigned int Local_u32Byte = 0;
+    uint32_t Local_u32Index = 0;
+
+    for (Local_u32Index = 0; Local_u32Index < AES128_BLOCK_SIZE; Local_u32Index++)
+    {
+        if (1 != sscanf(&Copy_pcHex[2u * Local_u32Index], "%2x", &Local_u32Byte))
+        {
+            return 1;
+        }
+        Copy_pu8Counter[Local_u32Index] = (uint8_t)Local_u32Byte;
+    }
+
+    return (Copy_pcHex[2u * AES128_BLOCK_SIZE] != '\0');
+}
+
+int main(int argc, char **argv)
+{
+    AES128_context Local_stContext;
+    uint8_t Local_u8arrCounter[AES128_BLOCK_SIZE];
+    uint8_t *Local_pu8Image = NULL;
+    long Local_s32Length = 0;
+    FILE *Local_pstFile = NULL;
+
+    // Step 1: Check the arguments
+    if ((argc != 4) || (0 != ParseCounter(argv[1], Local_u8arrCounter)))
+    {
+        fprintf(stderr, "usage: %s <initial counter, 32 hex digits> <image.bin> <image.enc>\n", argv[0]);
+        return 1;
+    }
+
+    // Step 2: Read the plaintext image
+    Local_pstFile = fopen(argv[2], "rb");
+    if ((NULL == Local_pstFile) || (0 != fseek(Local_pstFile, 0, SEEK_END)) || ((Local_s32Length = ftell(Local_pstFile)) <= 0) ||
+        (0 != fseek(Local_pstFile, 0, SEEK_SET)) || (NULL == (Local_pu8Image = malloc((size_t)Local_s32Length))) ||
+        ((size_t)Local_s32Length != fread(Local_pu8Image, 1, (size_t)Local_s32Length, Local_pstFile)))
+    {
+        fprintf(stderr, "cannot read %s\n", argv[2]);
+        return 1;
+    }
+    fclose(Local_pstFile);
+
+    // Step 3: Encrypt from keystream offset 0, the image starts at FLASH_SECTOR2_BASE_ADDRESS
+    AES128_vInit(&Local_stContext, Global_u8arrKey);
+    AES128_vCtrCrypt(&Local_stContext, Local_u8arrCounter, 0, Local_pu8Image, (uint32_t)Local_s32Length);
+
+    // Step 4: Write the encrypted image
+    Local_pstFile = fopen(argv[3], "wb");
+    if ((NULL == Local_pstFile) || ((size_t)Local_s32Length != fwrite(Local_pu8Image, 1, (size_t)Local_s32Length, Local_pstFile)) ||
+        (0 != fclose(Local_pstFile)))
+    {
+        fprintf(stderr, "cannot write %s\n", argv[3]);
+        return 1;
+    }
+    free(Local_pu8Image);
+
+    return 0;
+}